@@ -0,0 +1,594 @@
+/*******************************************************************************
+ * Projekt:         Programování síťové služby: Sniffer CDP a LLDP
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Měření propustnosti zpracování paketů. Předem vygenerovaný
+ *                  korpus rámců v paměti je posílán přes Sniffers::newPacket()
+ *                  bez knihovny pcap.
+ *
+ ******************************************************************************/
+
+/**
+ * @file pipeline_bench.cpp
+ *
+ * @brief End-to-end throughput benchmark of the in-process pipeline. Mixed corpus
+ *        of LLDP, CDP and background frames is pre-loaded into memory and pushed
+ *        through Sniffers::newPacket() with real LLDP and CDP sniffers and null
+ *        output sink. Reports frames/s, bytes/s and per-stage breakdown.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <netinet/in.h>
+
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+
+#include "../lib/sniffers.h"
+#include "../lib/sniffers/neighbor_table.h"
+
+using namespace std;
+
+/**
+  * Commandline flags of benchmark.
+  */
+enum flags {
+    FRAMES                      = 'n',  /**< count of frames in corpus */
+    ROUNDS                      = 'r',  /**< count of passes over corpus */
+    BACKGROUND                  = 'b',  /**< percentage of non-matching frames */
+    PROJECTION                  = 'p',  /**< decode only identification TLVs */
+    CORPUS                      = 'c',  /**< directory with corpus files */
+    NEIGHBORS                   = 't',  /**< keep neighbor table */
+    DEVICES                     = 'd',  /**< count of devices whose announcements repeat */
+    NO_DECODE_CACHE             = 'f'   /**< decode every PDU, without decode cache */
+};
+
+/**
+  * Stages of pipeline which are measured separately.
+  */
+enum stages {
+    STAGE_CLASSIFY              = 0,    /**< only sniffers validation */
+    STAGE_DECODE                = 1,    /**< validation + reading of TLVs */
+    STAGE_FORMAT                = 2,    /**< validation + TLVs + string conversion */
+    STAGES_COUNT                = 3
+};
+
+const string HELP =
+    "Pipeline benchmark\n"
+    "Usage:\n"
+    "  \tpipeline_bench [-n <frames>] [-r <rounds>] [-b <background %>] [-p] [-c <directory>] [-t] [-d <devices>] [-f]\n"
+    "  \t-p decodes only chassis/device ID, port ID, TTL and system name\n"
+    "  \t-c repeats frames of files in directory (e.g. src/fuzz/corpus) instead of generated ones\n"
+    "  \t-t updates neighbor table by every decoded packet\n"
+    "  \t-d generated LLDP and CDP frames are periodic announcements of given count of devices\n"
+    "  \t-f disables decode cache, every PDU is decoded";
+
+static const int DEFAULT_FRAMES     = 100000;
+static const int DEFAULT_ROUNDS     = 10;
+static const int DEFAULT_BACKGROUND = 50;
+
+/**
+  * Currently measured stage, callbacks decide by it how much work to do.
+  */
+static int currentStage = STAGE_FORMAT;
+
+/**
+  * Neighbor table updated in decoding stage, NULL whether is not kept.
+  */
+static NeighborTable *neighbors = NULL;
+
+/**
+  * Null output sink. Summed length of formatted output keeps compiler from
+  * optimizing formatting away.
+  */
+static volatile unsigned long sinkBytes = 0;
+
+/**
+  * One frame of the corpus.
+  */
+typedef vector<u_int8_t> CorpusFrame;
+
+/**
+  * Appends big endian unsigned short to frame.
+  * @param frame Frame where value will be appended.
+  * @param value Value to be appended.
+  */
+static void appendUShort(CorpusFrame &frame, u_int16_t value) {
+    frame.push_back(value >> 8);
+    frame.push_back(value & 0xFF);
+}
+
+/**
+  * Appends big endian unsigned int to frame.
+  * @param frame Frame where value will be appended.
+  * @param value Value to be appended.
+  */
+static void appendUInt(CorpusFrame &frame, u_int32_t value) {
+    appendUShort(frame, value >> 16);
+    appendUShort(frame, value & 0xFFFF);
+}
+
+/**
+  * Appends string to frame.
+  * @param frame Frame where string will be appended.
+  * @param str String to be appended.
+  */
+static void appendStr(CorpusFrame &frame, const string &str) {
+    frame.insert(frame.end(), str.begin(), str.end());
+}
+
+/**
+  * Appends ethernet header to frame.
+  * @param frame Frame where header will be appended.
+  * @param dst Destination MAC address.
+  * @param seed Variation of source MAC address.
+  * @param type Ethernet type or length of frame.
+  */
+static void appendEthernet(CorpusFrame &frame, const u_int8_t *dst, int seed, u_int16_t type) {
+    frame.insert(frame.end(), dst, dst + EthernetFrame::ADDR_LEN);
+    frame.push_back(0x00); frame.push_back(0x1b); frame.push_back(0x54);
+    frame.push_back(seed >> 16); frame.push_back(seed >> 8); frame.push_back(seed);
+    appendUShort(frame, type);
+}
+
+/**
+  * Appends LLDP TLV to frame.
+  * @param frame Frame where TLV will be appended.
+  * @param type Type of TLV.
+  * @param value Value of TLV.
+  */
+static void appendLLDPTLV(CorpusFrame &frame, int type, const CorpusFrame &value) {
+    appendUShort(frame, (type << 9) | (value.size() & 0x01FF));
+    frame.insert(frame.end(), value.begin(), value.end());
+}
+
+/**
+  * Appends CDP TLV to frame.
+  * @param frame Frame where TLV will be appended.
+  * @param type Type of TLV.
+  * @param value Value of TLV.
+  */
+static void appendCDPTLV(CorpusFrame &frame, int type, const CorpusFrame &value) {
+    appendUShort(frame, type);
+    appendUShort(frame, CDPPacket::TL_SIZE + value.size());
+    frame.insert(frame.end(), value.begin(), value.end());
+}
+
+/**
+  * Builds LLDP frame typical for access switch.
+  * @param seed Variation of device.
+  * @return Built frame.
+  */
+static CorpusFrame buildLLDPFrame(int seed) {
+    static const u_int8_t DST[] = {0x01, 0x80, 0xc2, 0x00, 0x00, 0x0e};
+    CorpusFrame frame, value;
+
+    appendEthernet(frame, DST, seed, LLDPPacket::ETHER_TYPE);
+
+    value.push_back(LLDPPacket::ChassisID::macAddress);
+    value.push_back(0x00); value.push_back(0x1b); value.push_back(0x54);
+    value.push_back(seed >> 16); value.push_back(seed >> 8); value.push_back(seed);
+    appendLLDPTLV(frame, LLDPPacket::chassisID, value);
+
+    value.assign(1, LLDPPacket::PortID::interfaceName);
+    appendStr(value, "GigabitEthernet1/0/" + Data::toStr(seed % 48 + 1));
+    appendLLDPTLV(frame, LLDPPacket::portID, value);
+
+    value.clear();
+    appendUShort(value, 120);
+    appendLLDPTLV(frame, LLDPPacket::timeToLive, value);
+
+    value.clear();
+    appendStr(value, "uplink to distribution");
+    appendLLDPTLV(frame, LLDPPacket::portDescription, value);
+
+    value.clear();
+    appendStr(value, "access-sw-" + Data::toStr(seed));
+    appendLLDPTLV(frame, LLDPPacket::systemName, value);
+
+    value.clear();
+    appendStr(value, "Cisco IOS Software, C2960 Software (C2960-LANBASEK9-M), "
+        "Version 12.2(55)SE5, RELEASE SOFTWARE (fc1)");
+    appendLLDPTLV(frame, LLDPPacket::systemDescription, value);
+
+    value.clear();
+    appendUShort(value, LLDPPacket::SystemCapabilities::MACBridge | LLDPPacket::SystemCapabilities::router);
+    appendUShort(value, LLDPPacket::SystemCapabilities::MACBridge);
+    appendLLDPTLV(frame, LLDPPacket::systemCapabilities, value);
+
+    value.clear();
+    value.push_back(5);                                         // address string length
+    value.push_back(LLDPPacket::ManagementAddress::IPv4);
+    appendUInt(value, 0x0a000000 | (seed & 0xFFFF));
+    value.push_back(LLDPPacket::ManagementAddress::ifIndex);
+    appendUInt(value, seed % 48 + 1);
+    value.push_back(0);                                         // OID length
+    appendLLDPTLV(frame, LLDPPacket::managementAddress, value);
+
+    appendLLDPTLV(frame, LLDPPacket::endOfLLPDU, CorpusFrame());
+
+    return frame;
+}
+
+/**
+  * Builds CDP frame typical for access switch.
+  * @param seed Variation of device.
+  * @return Built frame.
+  */
+static CorpusFrame buildCDPFrame(int seed) {
+    static const u_int8_t DST[] = {0x01, 0x00, 0x0c, 0xcc, 0xcc, 0xcc};
+    static const u_int8_t LLC[] = {0xaa, 0xaa, 0x03, 0x00, 0x00, 0x0c, 0x20, 0x00};
+    CorpusFrame frame, cdp, value;
+    u_int16_t checksum;
+
+    cdp.push_back(0x02);                                        // version
+    cdp.push_back(180);                                         // time to live
+    appendUShort(cdp, 0);                                       // checksum
+
+    value.clear();
+    appendStr(value, "core-sw-" + Data::toStr(seed) + ".example.net");
+    appendCDPTLV(cdp, CDPPacket::deviceID, value);
+
+    value.clear();
+    appendUInt(value, 1);                                       // count of addresses
+    value.push_back(CDPPacket::Addresses::NLPID);
+    value.push_back(1);
+    value.push_back(CDPPacket::Addresses::IP);
+    appendUShort(value, 4);
+    appendUInt(value, 0x0a010000 | (seed & 0xFFFF));
+    appendCDPTLV(cdp, CDPPacket::addresses, value);
+
+    value.clear();
+    appendStr(value, "GigabitEthernet0/" + Data::toStr(seed % 24 + 1));
+    appendCDPTLV(cdp, CDPPacket::portID, value);
+
+    value.clear();
+    appendUInt(value, CDPPacket::Capabilities::router | CDPPacket::Capabilities::switchL2
+        | CDPPacket::Capabilities::IGMPCapable);
+    appendCDPTLV(cdp, CDPPacket::capabilities, value);
+
+    value.clear();
+    appendStr(value, "Cisco IOS Software, C3750 Software (C3750-IPSERVICESK9-M), "
+        "Version 12.2(55)SE5, RELEASE SOFTWARE (fc1)\n"
+        "Technical Support: http://www.cisco.com/techsupport\n"
+        "Copyright (c) 1986-2012 by Cisco Systems, Inc.\n"
+        "Compiled Thu 09-Feb-12 18:14 by prod_rel_team");
+    appendCDPTLV(cdp, CDPPacket::softwareVersion, value);
+
+    value.clear();
+    appendStr(value, "cisco WS-C3750G-24TS");
+    appendCDPTLV(cdp, CDPPacket::platform, value);
+
+    value.assign(1, 1);
+    appendCDPTLV(cdp, CDPPacket::duplex, value);
+
+    value.clear();
+    appendUInt(value, 1500);
+    appendCDPTLV(cdp, CDPPacket::mtu, value);
+
+    checksum = Data::checksum(Data(&cdp[0], cdp.size()), 0);
+    cdp[CDPPacket::CHECKSUM_OFFSET] = checksum >> 8;
+    cdp[CDPPacket::CHECKSUM_OFFSET + 1] = checksum & 0xFF;
+
+    appendEthernet(frame, DST, seed, sizeof(LLC) + cdp.size());
+    frame.insert(frame.end(), LLC, LLC + sizeof(LLC));
+    frame.insert(frame.end(), cdp.begin(), cdp.end());
+
+    return frame;
+}
+
+/**
+  * Builds frame which does not match any sniffer (IPv4 or spanning tree).
+  * @param seed Variation of frame.
+  * @return Built frame.
+  */
+static CorpusFrame buildBackgroundFrame(int seed) {
+    static const u_int8_t DST[] = {0x00, 0x50, 0x56, 0x00, 0x00, 0x01};
+    static const u_int8_t STP_DST[] = {0x01, 0x80, 0xc2, 0x00, 0x00, 0x00};
+    static const u_int8_t STP_LLC[] = {0x42, 0x42, 0x03};
+    CorpusFrame frame;
+    int size;
+
+    if (seed % 10 == 0) {   // spanning tree BPDU - passes LLC layer, but it is not CDP
+        appendEthernet(frame, STP_DST, seed, 38);
+        frame.insert(frame.end(), STP_LLC, STP_LLC + sizeof(STP_LLC));
+        frame.resize(frame.size() + 35, 0);
+    } else {                // IPv4 frame from 60 B up to full sized frame
+        size = 60 + (seed * 7919) % (EthernetFrame::MAX_SIZE - 4 - 60);
+        appendEthernet(frame, DST, seed, 0x0800);
+        while (int(frame.size()) < size) {
+            frame.push_back((seed + frame.size()) & 0xFF);
+        }
+    }
+
+    return frame;
+}
+
+/**
+  * Loads every file of directory as one frame, e.g. fuzzing corpus
+  * with malformed frames.
+  * @param path Path to directory.
+  * @param frames Loaded frames are appended here.
+  * @return True on success else false.
+  */
+static int loadCorpus(const string &path, vector<CorpusFrame> &frames) {
+    struct dirent *entry;
+    DIR *dir;
+
+    if ((dir = opendir(path.c_str())) == NULL) {
+        cerr << path << ": unable open directory" << endl;
+        return 0;
+    }
+
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] == '.') {  // skipping hidden files, "." and ".."
+            continue;
+        }
+        ifstream file((path + "/" + entry->d_name).c_str(), ios::in | ios::binary);
+        frames.push_back(CorpusFrame((istreambuf_iterator<char>(file)), istreambuf_iterator<char>()));
+        if (frames.back().empty()) {    // frame has to have some data
+            frames.pop_back();
+        }
+    }
+
+    closedir(dir);
+
+    if (frames.empty()) {
+        cerr << path << ": no frames" << endl;
+        return 0;
+    }
+
+    return 1;
+}
+
+/**
+  * Returns current monotonic time in seconds.
+  * @return Current time in seconds.
+  */
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+  * Null sink callback for LLDP packet.
+  * @param packet Captured LLDP packet
+  */
+void callback_LLDPPacket(const LLDPPacket *packet) {
+    TLVs tlvs;
+    TLVs::const_iterator it;
+    const TLVs &decoded = packet->decode(tlvs);    // the same PDU may be already decoded
+
+    if (neighbors) {
+        sinkBytes += neighbors->update(LLDP_PROTOCOL, decoded, 0, 0);
+    }
+
+    if (currentStage < STAGE_FORMAT) return;
+
+    for (it = decoded.begin(); it != decoded.end(); ++it) {
+        sinkBytes += (*it)->getTypeName().length() + (*it)->getSubTypeName().length() + (*it)->getValueStr().length();
+    }
+}
+
+/**
+  * Null sink callback for CDP packet.
+  * @param packet Captured CDP packet
+  */
+void callback_CDPPacket(const CDPPacket *packet) {
+    TLVs tlvs;
+    TLVs::const_iterator it;
+    const TLVs &decoded = packet->decode(tlvs);    // the same PDU may be already decoded
+
+    if (neighbors) {
+        sinkBytes += neighbors->update(CDP_PROTOCOL, decoded, packet->getHeader().timeToLive, 0);
+    }
+
+    if (currentStage < STAGE_FORMAT) return;
+
+    sinkBytes += packet->testCheckSum();
+    for (it = decoded.begin(); it != decoded.end(); ++it) {
+        sinkBytes += (*it)->getTypeName().length() + (*it)->getValueStr().length();
+    }
+}
+
+/**
+  * Pushes whole corpus through pipeline.
+  * @param sniffers Sniffers with registered LLDP and CDP sniffer.
+  * @param corpus Frames to be processed.
+  * @param rounds Count of passes over corpus.
+  * @param stage Measured stage.
+  * @return Elapsed time in seconds.
+  */
+static double runStage(Sniffers &sniffers, const vector<CorpusFrame> &corpus, int rounds, int stage) {
+    vector<CorpusFrame>::const_iterator it;
+    Sniffer *lldp = new LLDPSniffer, *cdp = new CDPSniffer;
+    Packet *packet;
+    double start;
+    int batch = 0;
+
+    currentStage = stage;
+    start = now();
+
+    for (int i = 0; i < rounds; i++) {
+        for (it = corpus.begin(); it != corpus.end(); ++it) {
+            if (++batch == Sniffer::BATCH_SIZE) {   // the same batching as in listening
+                sniffers.batchDone();
+                batch = 0;
+            }
+
+            // the same as in Sniffer::listening()
+            packet = new Packet(Data(&(*it)[0], it->size()));
+            packet->protocols.push_back(DLT_EN10MB);
+
+            if (stage == STAGE_CLASSIFY) {
+                sinkBytes += lldp->validatePacket(*packet) + cdp->validatePacket(*packet);
+            } else {
+                sniffers.newPacket(packet);
+            }
+
+            delete packet;
+        }
+    }
+
+    delete lldp;
+    delete cdp;
+
+    return now() - start;
+}
+
+int main(int argc, char *argv[]) {
+    int frames = DEFAULT_FRAMES, rounds = DEFAULT_ROUNDS, background = DEFAULT_BACKGROUND;
+    int lldpFrames = 0, cdpFrames = 0, backgroundFrames = 0, ok = 1;
+    unsigned long corpusBytes = 0;
+    u_int64_t hits, misses;
+    vector<CorpusFrame> corpus;
+    double elapsed[STAGES_COUNT];
+    double processed, perFrame;
+    Packet::Projection lldpProjection, cdpProjection;
+    vector<CorpusFrame> loaded;
+    string corpusPath;
+    Sniffers sniffers;
+    NeighborTable table;
+    int projected = 0, devices = 0, decodeCache = 1;
+    char ch;
+
+    // processing cmd line parameters
+    while ((ch = getopt(argc, argv, "n:r:b:pc:td:fh")) != -1) {
+        switch (ch) {
+        case FRAMES:
+            frames = Data::strToInt(optarg, &ok);
+            break;
+        case ROUNDS:
+            rounds = Data::strToInt(optarg, &ok);
+            break;
+        case BACKGROUND:
+            background = Data::strToInt(optarg, &ok);
+            break;
+        case PROJECTION:
+            projected = 1;
+            break;
+        case CORPUS:
+            corpusPath = optarg;
+            break;
+        case NEIGHBORS:
+            neighbors = &table;
+            break;
+        case DEVICES:
+            devices = Data::strToInt(optarg, &ok);
+            break;
+        case NO_DECODE_CACHE:
+            decodeCache = 0;
+            break;
+        default:
+            ok = 0;
+        }
+    }
+
+    if (!ok || frames <= 0 || rounds <= 0 || background < 0 || background > 100 || devices < 0) {
+        cerr << HELP << endl;
+        return 1;
+    }
+
+    if (!corpusPath.empty() && !loadCorpus(corpusPath, loaded)) {
+        return 1;
+    }
+
+    // generating corpus, background frames are spread evenly
+    corpus.reserve(frames);
+    for (int i = 0, spread = 0; i < frames; i++) {
+        if (!loaded.empty()) {          // loaded frames are just repeated
+            corpus.push_back(loaded[i % loaded.size()]);
+            corpusBytes += corpus.back().size();
+            continue;
+        }
+
+        spread += background;
+        if (spread >= 100) {
+            spread -= 100;
+            corpus.push_back(buildBackgroundFrame(i));
+            backgroundFrames++;
+        } else if ((lldpFrames + cdpFrames) % 2 == 0) {
+            corpus.push_back(buildLLDPFrame((devices) ? i % devices : i));
+            lldpFrames++;
+        } else {
+            corpus.push_back(buildCDPFrame((devices) ? i % devices : i));
+            cdpFrames++;
+        }
+        corpusBytes += corpus.back().size();
+    }
+
+    sniffers.addSnifferCallback<LLDPSniffer>(callback_LLDPPacket);
+    sniffers.addSnifferCallback<CDPSniffer>(callback_CDPPacket);
+
+    if (!decodeCache) {
+        sniffers.setDecodeCache(0);
+    }
+
+    if (projected) {    // typical consumer which identifies neighbors only
+        lldpProjection.selectNone();
+        lldpProjection.select(LLDPPacket::chassisID);
+        lldpProjection.select(LLDPPacket::portID);
+        lldpProjection.select(LLDPPacket::timeToLive);
+        lldpProjection.select(LLDPPacket::systemName);
+        sniffers.setProjection(LLDP_PROTOCOL, lldpProjection);
+
+        cdpProjection.selectNone();     // TTL is part of CDP header
+        cdpProjection.select(CDPPacket::deviceID);
+        cdpProjection.select(CDPPacket::portID);
+        cdpProjection.select(CDPPacket::systemName);
+        sniffers.setProjection(CDP_PROTOCOL, cdpProjection);
+    }
+
+    runStage(sniffers, corpus, 1, STAGE_FORMAT);    // warm up
+
+    for (int stage = STAGE_CLASSIFY; stage < STAGES_COUNT; stage++) {
+        elapsed[stage] = runStage(sniffers, corpus, rounds, stage);
+    }
+
+    processed = double(frames) * rounds;
+
+    if (loaded.empty()) {
+        cout << "Corpus: " << frames << " frames (LLDP: " << lldpFrames << ", CDP: " << cdpFrames
+             << ", background: " << backgroundFrames << "), " << corpusBytes << " B" << endl;
+    } else {
+        cout << "Corpus: " << frames << " frames (" << loaded.size() << " files of " << corpusPath
+             << " repeated), " << corpusBytes << " B" << endl;
+    }
+    cout << "Rounds: " << rounds << ((projected) ? " (projected decoding)" : "") << endl;
+    if (decodeCache) {
+        hits = sniffers.decodeCache(LLDP_PROTOCOL)->hits + sniffers.decodeCache(CDP_PROTOCOL)->hits;
+        misses = sniffers.decodeCache(LLDP_PROTOCOL)->misses + sniffers.decodeCache(CDP_PROTOCOL)->misses;
+        cout << "Decode cache: " << hits << " hits of " << hits + misses << " PDUs" << endl;
+    }
+    if (neighbors) {
+        cout << "Neighbors: " << neighbors->size() << " (shared strings: " << neighbors->strings().size()
+             << ", " << neighbors->strings().bytes() << " B)" << endl;
+    }
+    cout << string(80, '-') << endl;
+
+    cout << fixed << setprecision(1);
+    cout << "Stage" << setw(35) << "[ns/frame]" << endl;
+    for (int stage = STAGE_CLASSIFY; stage < STAGES_COUNT; stage++) {
+        perFrame = (elapsed[stage] - ((stage) ? elapsed[stage - 1] : 0)) / processed * 1e9;
+        cout << ((stage == STAGE_CLASSIFY) ? "classification" : (stage == STAGE_DECODE) ? "decoding      " : "formatting    ")
+             << setw(26) << perFrame << endl;
+    }
+
+    cout << string(80, '-') << endl;
+    cout << "Total [ns/frame]: " << elapsed[STAGE_FORMAT] / processed * 1e9 << endl;
+    cout << "Frames/s: " << setprecision(0) << processed / elapsed[STAGE_FORMAT] << endl;
+    cout << "Bytes/s: " << corpusBytes * double(rounds) / elapsed[STAGE_FORMAT] << endl;
+
+    return (sinkBytes) ? 0 : 1;
+}
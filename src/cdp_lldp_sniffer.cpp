@@ -23,12 +23,18 @@
 #include <signal.h>
 
 #include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <ctime>
 #include <string>
 #include <map>
+#include <algorithm>
 #include <cstdlib>
 
 #include "network.h"
+#include "config_file.h"
 #include "lib/sniffers.h"
+#include "lib/sniffers/neighbor_table.h"
 
 using namespace std;
 
@@ -41,7 +47,14 @@ enum flags {
     INTERFACE                   = 'i',  /**< interface arguemnt is follows */
     TTL                         = 't',  /**< time to live value of packet */
     INTERVAL                    = 'r',  /**< packet generation interval */
-    CDP                         = 'c'   /**< CDP sender is demanded */
+    CDP                         = 'c',  /**< CDP sender is demanded */
+    METRICS                     = 'm',  /**< file for export of metrics */
+    BUFFER                      = 'b',  /**< ceiling of kernel capture buffer */
+    SNAPLEN                     = 'n',  /**< captured bytes of each frame */
+    LOW_LATENCY                 = 'f',  /**< low latency capture */
+    TIMEOUT                     = 'w',  /**< read timeout of capture */
+    FILTER                      = 'e',  /**< filter restricting captured frames */
+    CONFIG                      = 'k'   /**< configuration file */
 };
 
 /**
@@ -62,7 +75,7 @@ enum errors {
 const string HELP =
     "ISA - Sniffer CDP a LLDP\n"
     "Použití:\n"
-    "  \txlosko01 [-l|-s] -i <rozhraní> [-c] [-t <int>] [-r <int>]\n"
+    "  \txlosko01 [-l|-s] -i <rozhraní> [-c] [-t <int>] [-r <int>] [-m <soubor>] [-b <KiB>] [-n <B>] [-f] [-w <ms>] [-e <filtr>] [-k <soubor>]\n"
     "\n"
     "Přepínače:\n"
     "-i\t- název rozhraní\n"
@@ -70,7 +83,14 @@ const string HELP =
     "-l\t- režim naslouchání na rozhraní\n"
     "-c\t- zasílání CDP paketů\n"
     "-t\t- doba běhu programu v režimu zasílání paketů (v sekundách)\n"
-    "-r\t- interval odesílání paketů (v sekundách)";
+    "-r\t- interval odesílání paketů (v sekundách)\n"
+    "-m\t- soubor pro průběžný export čítačů ve formátu Prometheus\n"
+    "-b\t- maximální velikost bufferu jádra (v KiB), při ztrátách paketů se buffer zvětšuje až do této velikosti\n"
+    "-n\t- počet zachytávaných bajtů z každého rámce (výchozí 1518)\n"
+    "-f\t- okamžité doručování zachycených rámců (nízká latence)\n"
+    "-w\t- doba čekání jádra na další rámce před doručením (v milisekundách, výchozí 1000, s -f 50)\n"
+    "-e\t- filtr (syntaxe pcap) omezující zachytávané rámce\n"
+    "-k\t- konfigurační soubor, po signálu SIGHUP je znovu načten";
 
 const string MSG_WRN_ARG_GARBAGE = "Upozornění: Některé parametry byly přeskočeny.";
 const string MSG_WRN_UNKNOWN_OPTION = "Upozornění: Neznámý přepínač: ";
@@ -85,6 +105,9 @@ const string MSG_ERR_SENDPACKET = "Chyba: Nebylo možné odeslat packet!";
 const string MSG_ERR_LISTEN = "Chyba: Nebylo možné spustit odposlech na zadaném zařízení!";
 const string MSG_ERR_LISTEN_DEVICE = "Chyba: Odposlech na rozhraní nelze spustit! Zkontrolujte název rozhraní.";
 const string MSG_WRN_INT_VALID = "Upozornění: Některý argument(y) byly vynechány kvůli neplatné konverzi na numerickou hodnotu.";
+const string MSG_ERR_CONFIG = "Chyba: Nelze načíst konfigurační soubor: ";
+const string MSG_WRN_CONFIG_KEY = "Upozornění: Neznámý nebo neplatný klíč konfigurace: ";
+const string MSG_WRN_RELOAD = "Upozornění: Konfiguraci nelze znovu načíst, zůstává původní.";
 
 /**
   * Default time to live value.
@@ -96,10 +119,54 @@ static const int DEFAULT_TTL        = 120;
   */
 static const int DEFAULT_INTERVAL   = 30;
 
+/**
+  * Upper limit of kernel buffer ceiling [KiB].
+  */
+static const int MAX_BUFFER_SIZE    = 1024 * 1024;
+
+/**
+  * Bounds of snaplen value [B].
+  */
+static const int MIN_SNAPLEN        = 64;
+static const int MAX_SNAPLEN        = 65535;
+
+/**
+  * Bounds of read timeout value [ms].
+  */
+static const int MIN_TIMEOUT        = 1;
+static const int MAX_TIMEOUT        = 60000;
+
 /**
   * Default parsing parameter from command line filter
   */
-static const string GETOPT_STRING = ":lsi:ct:r:";
+static const string GETOPT_STRING = ":lsi:ct:r:m:b:n:fw:e:k:";
+
+/**
+  * Keys of configuration file and corresponding command line flags.
+  */
+static const struct {
+    const char *key;            /**< Key in configuration file */
+    char flag;                  /**< Corresponding command line flag */
+    int isSwitch;               /**< Flag without argument, value is boolean */
+} CONFIG_KEYS[] = {
+    {"interface",   INTERFACE,      0},
+    {"listen",      LISTENER,       1},
+    {"send",        SENDER,         1},
+    {"cdp",         CDP,            1},
+    {"ttl",         TTL,            0},
+    {"interval",    INTERVAL,       0},
+    {"metrics",     METRICS,        0},
+    {"buffer",      BUFFER,         0},
+    {"snaplen",     SNAPLEN,        0},
+    {"low_latency", LOW_LATENCY,    1},
+    {"timeout",     TIMEOUT,        0},
+    {"filter",      FILTER,         0}
+};
+
+/**
+  * Flags with numeric argument.
+  */
+static const char NUMERIC_FLAGS[] = {TTL, INTERVAL, BUFFER, SNAPLEN, TIMEOUT};
 
 /**
   * Global object of sniffers.
@@ -107,24 +174,165 @@ static const string GETOPT_STRING = ":lsi:ct:r:";
 Sniffers sniffers;
 
 /**
-  * Signal handler that catches termination signals.
+  * Neighbors announced by captured packets.
+  */
+NeighborTable neighbors;
+
+/**
+  * Names of results of neighbor update indexed by result.
+  */
+static const char *const NEIGHBOR_UPDATES[] = {NULL, "new", "changed", "refreshed", "removed"};
+
+/**
+  * Flags typed on command line, configuration file is applied above them on reload.
+  */
+map<char, string> commandLineFlags;
+
+/**
+  * Loads configuration file and adds its values to flags.
+  * Flags already present (typed on command line) take precedence.
+  * @param path Path to configuration file.
+  * @param flags Map array with flags.
+  * @return True on success else false.
+  */
+int loadConfig(const string &path, map<char, string> &flags) {
+    ConfigFile::Values values;
+    ConfigFile::Values::iterator it;
+    string error;
+    unsigned i;
+    int ok;
+
+    if (!ConfigFile::load(path, values, error)) {
+        cerr << MSG_ERR_CONFIG << error << endl;
+        return 0;
+    }
+
+    for (it = values.begin(); it != values.end(); ++it) {
+        for (i = 0; i < sizeof(CONFIG_KEYS) / sizeof(CONFIG_KEYS[0]) && it->first != CONFIG_KEYS[i].key; i++);
+
+        if (i == sizeof(CONFIG_KEYS) / sizeof(CONFIG_KEYS[0])) {    // unknown key
+            cerr << MSG_WRN_CONFIG_KEY << it->first << endl;
+            continue;
+        }
+
+        if (flags.count(CONFIG_KEYS[i].flag)) {     // command line wins
+            continue;
+        }
+
+        if (!CONFIG_KEYS[i].isSwitch) {
+            flags[CONFIG_KEYS[i].flag] = it->second;
+        } else if (ConfigFile::toBool(it->second, &ok)) {
+            flags[CONFIG_KEYS[i].flag] = string();
+        } else if (!ok) {
+            cerr << MSG_WRN_CONFIG_KEY << it->first << endl;
+        }
+    }
+
+    return 1;
+}
+
+/**
+  * Checks numeric values of flags, invalid are removed.
+  * @param flags Map array with flags.
+  */
+void checkNumericFlags(map<char, string> &flags) {
+    int ok;
+
+    for (unsigned i = 0; i < sizeof(NUMERIC_FLAGS); i++) {
+        if (flags.count(NUMERIC_FLAGS[i])) {
+            Data::strToInt(flags[NUMERIC_FLAGS[i]], &ok);
+            if (!ok) {
+                cerr << MSG_WRN_INT_VALID << endl;
+                flags.erase(NUMERIC_FLAGS[i]);  // not valid, remove argument
+            }
+        }
+    }
+}
+
+/**
+  * Creates capture settings from flags.
+  * @param flags Map array with flags.
+  * @return Capture settings.
+  */
+Sniffer::CaptureConfig captureConfig(map<char, string> &flags) {
+    Sniffer::CaptureConfig config;
+
+    // preset at first
+    if (flags.count(LOW_LATENCY)) {
+        config = Sniffer::CaptureConfig::lowLatency();
+    }
+    // getting ceiling of kernel buffer, growing is disabled whether not set
+    if (flags.count(BUFFER)) {
+        config.maxBufferSize = min(max(Data::strToInt(flags[BUFFER]), 0), MAX_BUFFER_SIZE) * 1024;
+    }
+    // getting snaplen, shorter frames are decoded as truncated
+    if (flags.count(SNAPLEN)) {
+        config.snaplen = min(max(Data::strToInt(flags[SNAPLEN]), MIN_SNAPLEN), MAX_SNAPLEN);
+    }
+    // getting read timeout, overrides timeout of preset
+    if (flags.count(TIMEOUT)) {
+        config.timeout = min(max(Data::strToInt(flags[TIMEOUT]), MIN_TIMEOUT), MAX_TIMEOUT);
+    }
+
+    return config;
+}
+
+/**
+  * Signal handler that catches termination and reload signals.
+  * Only passes event to running loop, everything else is done there.
   * @param sig Signal number
   */
 void sighandler(int sig) {
-    // Prepare signal action structure for ignoring signal
+    sniffers.notify((sig == SIGHUP) ? Sniffers::EVENT_RELOAD : Sniffers::EVENT_STOP);
+}
+
+/**
+  * Installs signal handler for signal.
+  * @param sig Signal number
+  */
+void catchSignal(int sig) {
     struct sigaction sa;
-    sa.sa_handler = SIG_IGN;
-    sa.sa_flags = 0;
+    sa.sa_handler = sighandler;
+    sa.sa_flags = SA_RESTART;   // waiting in poll() is interrupted anyway
     sigemptyset(&sa.sa_mask);
 
-    // Ignoring SIGINT and SIGTERM
-    if ((sigaction(SIGINT, &sa, NULL) == -1) &&
-        ((sigaction(SIGTERM, &sa, NULL) == -1))) {
-        exit(sig);
+    if (sigaction(sig, &sa, NULL) == -1) {
+        perror("sigaction");
+    }
+}
+
+/**
+  * Is called from running loop on SIGHUP. Flushes output, loads configuration
+  * file again and applies it (mode of program can not be changed). Opened
+  * session is kept whether capture settings have not changed.
+  * @param instance Running sniffers.
+  */
+void reload(Sniffers &instance) {
+    map<char, string> flags = commandLineFlags;
+
+    cout << flush;
+
+    if (flags.count(CONFIG)) {
+        if (!loadConfig(flags[CONFIG], flags)) {
+            cerr << MSG_WRN_RELOAD << endl;
+            return;
+        }
+
+        checkNumericFlags(flags);
+        if (flags[INTERFACE].empty()) {
+            cerr << MSG_ERR_ARG_INTERFACE_MISSING << endl << MSG_WRN_RELOAD << endl;
+            return;
+        }
+
+        instance.metricsFile = flags[METRICS];
+        instance.setSchedule((flags.count(TTL))? Data::strToInt(flags[TTL]) : DEFAULT_TTL,
+            (flags.count(INTERVAL))? Data::strToInt(flags[INTERVAL]) : DEFAULT_INTERVAL);
+        instance.reconfigure(flags[INTERFACE], captureConfig(flags), flags[FILTER]);
     }
 
-    sniffers.stopListening(); // Termination of listening whether runs
-    sniffers.stopSending();   // Termination of sending whewther runs
+    if (!instance.metricsFile.empty()) {
+        instance.writeMetrics(instance.metricsFile);
+    }
 }
 
 /**
@@ -142,7 +350,8 @@ map<char, string> &getFlags(int argc, char **argv, map<char, string> &flags) {
     while ((ch = getopt(argc, argv, GETOPT_STRING.c_str())) != -1) {
         switch (ch) {
             // known parameter
-            case LISTENER: case SENDER: case INTERFACE: case CDP:case TTL: case INTERVAL:
+            case LISTENER: case SENDER: case INTERFACE: case CDP:case TTL: case INTERVAL: case METRICS: case BUFFER: case SNAPLEN: case LOW_LATENCY:
+            case TIMEOUT: case FILTER: case CONFIG:
                 optargString = (!optarg)? string() : optarg;        // getting argument whether has
                 flags.insert(pair<char, string>(ch, optargString)); // storing to map array
                 break;
@@ -169,13 +378,54 @@ map<char, string> &getFlags(int argc, char **argv, map<char, string> &flags) {
     return flags;
 }
 
+/**
+  * Converts capture timestamp to ISO 8601 UTC string with nanoseconds.
+  * @param timestamp Capture timestamp.
+  * @return Timestamp string.
+  */
+string timestampToStr(const struct timespec &timestamp) {
+    char buffer[32];
+    struct tm utc;
+    time_t seconds = timestamp.tv_sec;
+    stringstream out;
+
+    gmtime_r(&seconds, &utc);
+    strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &utc);
+    out << buffer << "." << setw(9) << setfill('0') << timestamp.tv_nsec << "Z";
+
+    return out.str();
+}
+
+/**
+  * Updates neighbor table by captured packet.
+  * @param protocol Protocol of packet.
+  * @param packet Captured packet.
+  * @param tlvs Decoded TLVs of packet.
+  * @param ttl Time to live of packet whether is not in TLVs.
+  * @return Result of update from NeighborTable::updates.
+  */
+int updateNeighbors(int protocol, const Packet *packet, const TLVs &tlvs, int ttl) {
+    time_t now = (packet->timestamp.tv_sec) ? packet->timestamp.tv_sec : time(NULL);
+
+    neighbors.expire(now);
+    return neighbors.update(protocol, tlvs, ttl, now);
+}
+
 /**
   * Prints info text about captured packet
-  * @param packet Name of packet which has been captured
+  * @param name Name of packet which has been captured
+  * @param packet Captured packet
+  * @param neighbor Result of neighbor update.
   */
-void printCaptureInfo(string packet) {
+void printCaptureInfo(string name, const Packet *packet, int neighbor) {
     cout << string(80, '-') << endl;
-    cout << " Captured packet: " << int(sniffers.lastCapturedPacketNumber() + 1) << " (" << packet << " packet)" << endl;
+    cout << " Captured packet: " << sniffers.capturedPackets() + 1 << " (" << name << " packet)" << endl;
+    if (packet->timestamp.tv_sec) {
+        cout << " Timestamp: " << timestampToStr(packet->timestamp) << endl;
+    }
+    if (neighbor != NeighborTable::NEIGHBOR_INVALID) {
+        cout << " Neighbor: " << NEIGHBOR_UPDATES[neighbor] << endl;
+    }
     cout << string(80, '-') << endl;
 }
 
@@ -184,15 +434,16 @@ void printCaptureInfo(string packet) {
   * @param packet Captured LLDP packet
   */
 void callback_LLDPPacket(const LLDPPacket *packet) {
-    TLVs tlvs = packet->readPacket();
-    TLVs::iterator it;
+    TLVs tlvs;
+    TLVs::const_iterator it;
+    const TLVs &decoded = packet->decode(tlvs);    // the same PDU may be already decoded
 
-    printCaptureInfo("LLDP");               // Printing info header
+    printCaptureInfo("LLDP", packet, updateNeighbors(LLDP_PROTOCOL, packet, decoded, DEFAULT_TTL)); // Printing info header
 
     cout << "<TLV STRUCTURES>" << endl;
 
     // printing recognized TLV structures in format "type: value" or "type (subtype): value"
-    for (it = tlvs.begin(); it != tlvs.end(); ++it) {
+    for (it = decoded.begin(); it != decoded.end(); ++it) {
         if ((*it)->getSubTypeName().length()) {     // subtype is set, print type name together with subtype name + value
             cout << "\t" <<  (*it)->getTypeName() << " (" << (*it)->getSubTypeName() << "): " << (*it)->getValueStr() << endl;
         } else {                                    // subtype not set, print only type name + value
@@ -209,10 +460,11 @@ void callback_LLDPPacket(const LLDPPacket *packet) {
   */
 void callback_CDPPacket(const CDPPacket *packet) {
     CDPPacket::Header header = packet->getHeader();
-    TLVs tlvs = packet->readPacket();
-    TLVs::iterator it;
+    TLVs tlvs;
+    TLVs::const_iterator it;
+    const TLVs &decoded = packet->decode(tlvs);    // the same PDU may be already decoded
 
-    printCaptureInfo("CDP");               // Printing info header
+    printCaptureInfo("CDP", packet, updateNeighbors(CDP_PROTOCOL, packet, decoded, header.timeToLive)); // Printing info header
 
     // printing CDP hader informations
     cout << "<HEADER>" << endl;
@@ -224,7 +476,7 @@ void callback_CDPPacket(const CDPPacket *packet) {
     cout << "<TLV STRUCTURES>" << endl;
 
     // printing TLV structures in format "type: value"
-    for (it = tlvs.begin(); it != tlvs.end(); ++it) {
+    for (it = decoded.begin(); it != decoded.end(); ++it) {
         cout << "\t" << (*it)->getTypeName() << ": " << (*it)->getValueStr() << endl;
     }
 
@@ -283,6 +535,9 @@ int translateListenErrors (int result) {
 int runSniffer(map<char, string> &flags) {
     int result = 0;
     sniffers.interface = flags[INTERFACE];
+    sniffers.metricsFile = flags[METRICS];
+    sniffers.captureFilter = flags[FILTER];
+    sniffers.config = captureConfig(flags);
     // getting ttl value
     int ttl = (flags.count(TTL))? Data::strToInt(flags[TTL]) : DEFAULT_TTL;
     // getting interval value
@@ -316,6 +571,25 @@ int runSniffer(map<char, string> &flags) {
     return result;
 }
 
+/**
+  * Prints summary of capture to callback completion latencies.
+  * @param name Name of protocol.
+  * @param histogram Latency histogram of protocol sniffer.
+  */
+void printLatency(string name, const LatencyHistogram *histogram) {
+    static const double PERCENTILES[] = {50, 90, 99, 99.9};
+
+    if (!histogram || !histogram->count()) {
+        return;
+    }
+
+    cout << name << " latency [us]: min " << histogram->min() / 1e3;
+    for (unsigned i = 0; i < sizeof(PERCENTILES) / sizeof(PERCENTILES[0]); i++) {
+        cout << ", p" << PERCENTILES[i] << " " << histogram->percentile(PERCENTILES[i]) / 1e3;
+    }
+    cout << ", max " << histogram->max() / 1e3 << " (" << histogram->count() << " packets)" << endl;
+}
+
 /**
   * Prints sniffer statistics when program is finnishing
   * @param flags Map array which contains run parameters.
@@ -323,26 +597,35 @@ int runSniffer(map<char, string> &flags) {
 void printSniffersInfo(map<char, string> &flags) {
     if (flags.count(LISTENER)) {    // listener mode finished
         cout << string(80, '=') << endl;
-        cout << "Captured packets: " << int(sniffers.lastCapturedPacketNumber() + 1) << endl;
-        cout << "Processed bytes [B]: " << int(sniffers.capturedBytes()) << endl;
+        cout << "Captured packets: " << sniffers.capturedPackets() << endl;
+        cout << "Processed bytes [B]: " << sniffers.capturedBytes() << endl;
+        cout << "Dropped by kernel: " << sniffers.statistics().kernelDrops << endl;
+        cout << "Truncated by snaplen: " << sniffers.statistics().truncated << endl;
+        cout << "Neighbors: " << neighbors.size() << " (shared strings: " << neighbors.strings().size()
+             << ", " << neighbors.strings().bytes() << " B)" << endl;
+        printLatency("LLDP", sniffers.latencyHistogram(LLDP_PROTOCOL));
+        printLatency("CDP", sniffers.latencyHistogram(CDP_PROTOCOL));
     } else {                        // sender mode finished
-        cout << "Sent packets: " << int(sniffers.lastSentPacketNumber() + 1) << endl;
-        cout << "Bytes [B]: " << int(sniffers.sentBytes()) << endl;
+        cout << "Sent packets: " << sniffers.sentPackets() << endl;
+        cout << "Bytes [B]: " << sniffers.sentBytes() << endl;
     }
 }
 
 int main(int argc, char* argv[]) {
     map<char, string> flags;
-    int ok = 1;
     int ret;
 
     // getting run parameters
     flags = getFlags(argc, argv, flags);
+    commandLineFlags = flags;
 
     // no params - print HELP text
     if (argc == 1) {
         cerr << HELP << endl;
         return 0;
+    // unable load configuration file
+    } else if (flags.count(CONFIG) && !loadConfig(flags[CONFIG], flags)) {
+        return ERR_ARGUMENTS;
     // missing interface name
     } else if ((!flags.count(INTERFACE)) || (flags[INTERFACE].empty())) {
         cerr << MSG_ERR_ARG_INTERFACE_MISSING << endl;
@@ -357,27 +640,14 @@ int main(int argc, char* argv[]) {
         return ERR_ARGUMENTS;
     }
 
-    // checking correct numeric value of TTL argument
-    if (flags.count(TTL)) {
-        Data::strToInt(flags[TTL], &ok);
-        if (!ok) {
-            cerr << MSG_WRN_INT_VALID << endl;
-            flags.erase(TTL);   // not valid, remove argument
-        }
-    }
-
-    // checking correct numeric value of interval argument
-    if (ok && flags.count(INTERVAL)) {
-        Data::strToInt(flags[INTERVAL], &ok);
-        if (!ok) {
-            cerr << MSG_WRN_INT_VALID << endl;
-            flags.erase(INTERVAL);  // not valid, remove argument
-        }
-    }
+    // checking correct numeric values of TTL, interval, buffer ceiling, snaplen and timeout
+    checkNumericFlags(flags);
 
-    // Catching SIGINT and SIGTERM for proper ending
-    signal(SIGINT, sighandler);
-    signal(SIGTERM, sighandler);
+    // Catching SIGINT and SIGTERM for proper ending, SIGHUP for reload
+    sniffers.reloadCallback = reload;
+    catchSignal(SIGINT);
+    catchSignal(SIGTERM);
+    catchSignal(SIGHUP);
 
     ret = runSniffer(flags);        // RUN SNIFFER
 
@@ -385,5 +655,7 @@ int main(int argc, char* argv[]) {
         printSniffersInfo(flags);
     }
 
+    cout << flush;                  // pending output before exit
+
     return ret;
 } 
@@ -0,0 +1,100 @@
+/*******************************************************************************
+ * Projekt:         Programování síťové služby: Sniffer CDP a LLDP
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Modul definující funkce pro načítání konfiguračního souboru.
+ *
+ ******************************************************************************/
+
+/**
+ * @file config_file.cpp
+ *
+ * @brief Module which defines functions for loading of configuration file.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <fstream>
+#include <sstream>
+#include "config_file.h"
+
+/**
+  * White characters which are trimmed.
+  */
+static const char *WHITESPACE = " \t\r\n";
+
+/**
+  * Removes leading and trailing white characters.
+  * @param str String to be trimmed.
+  * @return Trimmed string.
+  */
+static string trim(const string &str) {
+    string::size_type begin = str.find_first_not_of(WHITESPACE);
+
+    if (begin == string::npos) {
+        return string();
+    }
+
+    return str.substr(begin, str.find_last_not_of(WHITESPACE) - begin + 1);
+}
+
+/**
+  * Loads configuration file. Every non-empty line has format
+  * "key = value", lines starting with '#' are comments.
+  * @param path Path to configuration file.
+  * @param values Loaded pairs of key and value.
+  * @param error Description of error whether loading fails.
+  * @return True on success else false.
+  */
+int ConfigFile::load(const string &path, Values &values, string &error) {
+    ifstream file(path.c_str());
+    string line, key;
+    string::size_type separator;
+    stringstream message;
+
+    if (!file) {
+        error = "unable open " + path;
+        return 0;
+    }
+
+    values.clear();
+    for (int number = 1; getline(file, line); number++) {
+        line = trim(line);
+        if (line.empty() || line[0] == '#') {   // empty line or comment
+            continue;
+        }
+
+        separator = line.find('=');
+        key = trim(line.substr(0, separator));
+        if (separator == string::npos || key.empty()) {
+            message << path << ":" << number << ": expected \"key = value\"";
+            error = message.str();
+            return 0;
+        }
+
+        values[key] = trim(line.substr(separator + 1));
+    }
+
+    return 1;
+}
+
+/**
+  * Converts boolean value of configuration (yes/no, true/false, on/off, 1/0).
+  * @param value Value to be converted.
+  * @param ok Whether is passed, is set to false on invalid value.
+  * @return True/false.
+  */
+int ConfigFile::toBool(const string &value, int *ok) {
+    if (ok) *ok = 1;
+
+    if (value == "yes" || value == "true" || value == "on" || value == "1") {
+        return 1;
+    }
+
+    if (ok && !(value == "no" || value == "false" || value == "off" || value == "0")) {
+        *ok = 0;
+    }
+
+    return 0;
+}
@@ -0,0 +1,52 @@
+/*******************************************************************************
+ * Projekt:         Programování síťové služby: Sniffer CDP a LLDP
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Hlavičkový soubor deklarující funkce pro načítání
+ *                  konfiguračního souboru.
+ *
+ ******************************************************************************/
+
+/**
+ * @file config_file.h
+ *
+ * @brief Header file which declares functions for loading of configuration file.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef CONFIG_FILE_H
+#define CONFIG_FILE_H
+
+#include <map>
+#include <string>
+
+using namespace std;
+
+namespace ConfigFile {
+    /**
+      * Type of loaded configuration, key is mapped to its value.
+      */
+    typedef map<string, string> Values;
+
+    /**
+      * Loads configuration file. Every non-empty line has format
+      * "key = value", lines starting with '#' are comments.
+      * @param path Path to configuration file.
+      * @param values Loaded pairs of key and value.
+      * @param error Description of error whether loading fails.
+      * @return True on success else false.
+      */
+    int load(const string &path, Values &values, string &error);
+
+    /**
+      * Converts boolean value of configuration (yes/no, true/false, on/off, 1/0).
+      * @param value Value to be converted.
+      * @param ok Whether is passed, is set to false on invalid value.
+      * @return True/false.
+      */
+    int toBool(const string &value, int *ok = 0);
+}
+
+#endif
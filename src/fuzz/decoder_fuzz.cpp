@@ -0,0 +1,206 @@
+/*******************************************************************************
+ * Projekt:         Programování síťové služby: Sniffer CDP a LLDP
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Fuzzovací vstup dekodérů LLDP a CDP. Libovolná data jsou
+ *                  klasifikována, dekódována a všechny TLV převedeny na text.
+ *
+ ******************************************************************************/
+
+/**
+ * @file decoder_fuzz.cpp
+ *
+ * @brief Fuzzing harness of LLDP and CDP decoders. Arbitrary bytes are taken
+ *        as ethernet frame, classified by isThisProtocol(), fully decoded
+ *        and every TLV is converted to string, the same as in sniffer.
+ *
+ *        Built by "make fuzz" with address and undefined behaviour sanitizers
+ *        as standalone program which runs given files or directories (seed
+ *        corpus is in src/fuzz/corpus), so it can be used by AFL (@@).
+ *        With clang and -DFUZZ_LIBFUZZER -fsanitize=fuzzer only
+ *        LLVMFuzzerTestOneInput() is built and libFuzzer provides main().
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+
+#include "../lib/sniffers/packets/lldp_packet.h"
+#include "../lib/sniffers/packets/cdp_packet.h"
+#include "../lib/sniffers/packets/tlv_arena.h"
+#include "../lib/sniffers/decode_cache.h"
+
+using namespace std;
+
+/**
+  * Output sink which keeps formatting from being optimized away.
+  */
+static volatile unsigned long sinkBytes = 0;
+
+/**
+  * Converts all TLVs to strings.
+  * @param tlvs Decoded TLVs.
+  */
+static void formatTLVs(const TLVs &tlvs) {
+    TLVs::const_iterator it;
+
+    for (it = tlvs.begin(); it != tlvs.end(); ++it) {
+        sinkBytes += (*it)->getTypeName().length() + (*it)->getSubTypeName().length()
+            + (*it)->getValueStr().length();
+    }
+}
+
+/**
+  * Passes frame through decode cache. PDU is admitted on the second
+  * sighting, so the cached decoding is formatted as well.
+  * @param cache Decode cache of protocol.
+  * @param packet Classified packet.
+  */
+template<class PacketType>
+static void formatCached(DecodeCache &cache, PacketType &packet) {
+    TLVs tlvs;
+
+    packet.decodeCache = &cache;
+    for (int i = 0; i < 2; i++) {
+        formatTLVs(packet.decode(tlvs));
+    }
+    packet.decodeCache = NULL;
+}
+
+/**
+  * Passes one frame through classification, decoding and formatting.
+  * Frame is copied into buffer of exact size so that sanitizer
+  * detects every read behind the end.
+  * @param data Data of frame.
+  * @param size Size of frame.
+  * @return Always 0.
+  */
+extern "C" int LLVMFuzzerTestOneInput(const u_int8_t *data, size_t size) {
+    static Packet::Counters counters;
+    static TLVArena arena;
+    static DecodeCache lldpCache, cdpCache;
+    u_int8_t *frame = new u_int8_t[size ? size : 1];
+    TLVs tlvs;
+
+    if (size) {
+        memcpy(frame, data, size);
+    }
+
+    Packet packet(Data(frame, size));
+    packet.protocols.push_back(DLT_EN10MB);
+
+    // the same order as sniffers classify and decode frames
+    if (LLDPPacket::isThisProtocol(&packet)) {
+        LLDPPacket lldp(packet.getData(), packet.protocols);
+        lldp.counters = &counters;
+        lldp.arena = &arena;
+        sinkBytes += lldp.getSize();
+        lldp.readPacket(tlvs);
+        formatTLVs(tlvs);
+        formatCached(lldpCache, lldp);
+    }
+
+    packet.protocols.resize(1);
+    if (CDPPacket::isThisProtocol(&packet)) {
+        CDPPacket cdp(packet.getData(), packet.protocols);
+        cdp.counters = &counters;
+        cdp.arena = &arena;
+        sinkBytes += cdp.getSize() + cdp.getHeader().version + cdp.testCheckSum();
+        cdp.readPacket(tlvs);
+        formatTLVs(tlvs);
+        formatCached(cdpCache, cdp);
+    }
+
+    tlvs.clear();               // TLVs has to be destructed before arena is reset
+    arena.reset();
+    delete[] frame;
+
+    return 0;
+}
+
+#ifndef FUZZ_LIBFUZZER
+
+/**
+  * Runs harness on content of file.
+  * @param path Path to file.
+  * @return True on success else false.
+  */
+static int runFile(const string &path) {
+    ifstream file(path.c_str(), ios::in | ios::binary);
+    vector<u_int8_t> content((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+
+    if (file.bad()) {
+        cerr << path << ": unable read file" << endl;
+        return 0;
+    }
+
+    LLVMFuzzerTestOneInput((content.empty()) ? NULL : &content[0], content.size());
+    return 1;
+}
+
+/**
+  * Runs harness on file or on all files of directory.
+  * @param path Path to file or directory.
+  * @param count Count of run files is added here.
+  * @return True on success else false.
+  */
+static int runPath(const string &path, int &count) {
+    struct stat info;
+    struct dirent *entry;
+    DIR *dir;
+    int ok = 1;
+
+    if (stat(path.c_str(), &info) == -1) {
+        cerr << path << ": no such file or directory" << endl;
+        return 0;
+    }
+
+    if (!S_ISDIR(info.st_mode)) {
+        count++;
+        return runFile(path);
+    }
+
+    if ((dir = opendir(path.c_str())) == NULL) {
+        cerr << path << ": unable open directory" << endl;
+        return 0;
+    }
+
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] != '.') {  // skipping hidden files, "." and ".."
+            ok &= runPath(path + "/" + entry->d_name, count);
+        }
+    }
+
+    closedir(dir);
+    return ok;
+}
+
+int main(int argc, char *argv[]) {
+    int count = 0, ok = 1;
+
+    if (argc < 2) {
+        cerr << "Usage:\n  \tdecoder_fuzz <file|directory>..." << endl;
+        return 1;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        ok &= runPath(argv[i], count);
+    }
+
+    cout << "Decoded inputs: " << count << endl;
+
+    return (ok) ? 0 : 1;
+}
+
+#endif
@@ -17,6 +17,14 @@
  */
 
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <ctime>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
 #include "sniffers.h"
 
 using namespace std;
@@ -26,6 +34,24 @@ using namespace std;
   */
 u_int8_t packet_buff[EthernetFrame::MAX_SIZE];
 
+/**
+  * Constructor, prepares self-pipe for events.
+  */
+Sniffers::Sniffers():Sniffer(), reloadCallback(NULL), metricsInterval(DEFAULT_METRICS_INTERVAL),
+    sending(0), sendTtl(0), sendInterval(0), lastKernelDrops(0), lastInterfaceDrops(0), checkedKernelDrops(0),
+    nextMetricsExport(0), nextDropsCheck(0) {
+
+    if (pipe(eventPipe) == -1) {    // events will not be delivered, stopping by flags only
+        perror("Unable create event pipe");
+        eventPipe[0] = eventPipe[1] = -1;
+    } else {                        // neither signal handler nor draining can block
+        fcntl(eventPipe[0], F_SETFL, fcntl(eventPipe[0], F_GETFL) | O_NONBLOCK);
+        fcntl(eventPipe[1], F_SETFL, fcntl(eventPipe[1], F_GETFL) | O_NONBLOCK);
+    }
+
+    eventFd = eventPipe[0];
+}
+
 /**
   * Desctructor
   */
@@ -36,6 +62,11 @@ Sniffers::~Sniffers() {
     for (pos = sniffers.begin(); pos != sniffers.end(); ++pos) {
         delete *pos;
     }
+
+    if (eventPipe[0] != -1) {
+        close(eventPipe[0]);
+        close(eventPipe[1]);
+    }
 }
 
 /**
@@ -44,19 +75,19 @@ Sniffers::~Sniffers() {
   */
 int Sniffers::startListening() {
     int ret;
-    string filter;
-    vector<Sniffer *>::iterator pos;
 
-    // creating final filter where are specified all demanded sniffer filters
-    for (pos = sniffers.begin(); pos != sniffers.end(); ++pos) {
-        filter += "(" + (*pos)->filter + ") or ";
-    }
-
-    filter.resize(filter.size() - 4);   // removing last "or"
-    this->filter = filter;
+    filter = buildFilter();
+    keyDecodeCaches();
 
+    nextMetricsExport = time(NULL) + metricsInterval;
+    nextDropsCheck = time(NULL) + DROPS_CHECK_INTERVAL;
+    checkedKernelDrops = stats.kernelDrops;
     ret = Sniffer::startListening();    // listening
 
+    if (!metricsFile.empty()) {         // final state of counters
+        writeMetrics(metricsFile);
+    }
+
     if (ret) {                          // testing return value for errors
         switch (ret) {                  // determining error type
         case Sniffer::EOPEN_DEVICE:
@@ -70,23 +101,242 @@ int Sniffers::startListening() {
     return ret;
 }
 
+/**
+  * Creates filter of session from filters of all sniffers and capture filter.
+  * @return Filter of session.
+  */
+string Sniffers::buildFilter() {
+    string filter;
+    vector<Sniffer *>::iterator pos;
+
+    // creating final filter where are specified all demanded sniffer filters
+    for (pos = sniffers.begin(); pos != sniffers.end(); ++pos) {
+        filter += "(" + (*pos)->filter + ") or ";
+    }
+
+    if (!filter.empty()) {
+        filter.resize(filter.size() - 4);   // removing last "or"
+    }
+
+    if (!captureFilter.empty()) {           // restricting by user filter
+        filter = (filter.empty()) ? captureFilter : "(" + filter + ") and (" + captureFilter + ")";
+    }
+
+    return filter;
+}
+
+/**
+  * Keys decode caches of all sniffers by current interface.
+  */
+void Sniffers::keyDecodeCaches() {
+    vector<Sniffer *>::iterator pos;
+
+    for (pos = sniffers.begin(); pos != sniffers.end(); ++pos) {
+        (*pos)->decodeCache.setInterface(interface);
+    }
+}
+
+/**
+  * Applies new capture settings. Opened session is kept whether interface
+  * and session settings are unchanged, when only filter differs just new
+  * filter is installed. On failure the previous settings are restored.
+  * @param interface Name of interface.
+  * @param config Capture settings.
+  * @param captureFilter Additional filter restricting captured frames, empty for none.
+  * @return True on valid reconfiguration else false.
+  */
+int Sniffers::reconfigure(const string &interface, const CaptureConfig &config, const string &captureFilter) {
+    const string oldInterface = this->interface, oldCaptureFilter = this->captureFilter;
+    const CaptureConfig oldConfig = this->config;
+    int reopen, ret = 0;
+
+    this->interface = interface;
+    this->config = config;
+    this->captureFilter = captureFilter;
+    keyDecodeCaches();
+
+    // buffer grown due to drops is kept whether it is still under ceiling
+    if (!config.bufferSize && (!config.maxBufferSize || oldConfig.bufferSize <= config.maxBufferSize)) {
+        this->config.bufferSize = oldConfig.bufferSize;
+    }
+
+    reopen = interface != oldInterface || !oldConfig.sameSession(this->config);
+    if (!sessionHandle || (!reopen && captureFilter == oldCaptureFilter)) {
+        return 0;                   // nothing to do with session
+    }
+
+    filter = buildFilter();
+    if (reopen) {
+        cerr << interface << ": capture settings changed, reopening session" << endl;
+        ret = reopenSession();
+    } else {
+        ret = installFilter();      // old filter stays installed on failure
+    }
+
+    if (ret) {                      // going back to the previous settings
+        cerr << interface << ": unable apply new capture settings, previous kept" << endl;
+        this->interface = oldInterface;
+        this->config = oldConfig;
+        this->captureFilter = oldCaptureFilter;
+        filter = buildFilter();
+        keyDecodeCaches();
+        if (reopen) {
+            reopenSession();
+        }
+    }
+
+    return ret;
+}
+
 /**
   * Is called when new packet is captured during listening.
   * @param packet Captured packet.
   */
 void Sniffers::newPacket(Packet *packet) {
     vector<Sniffer *>::iterator pos;
+    struct timespec now;
+    int64_t delta;
+    int classified = 0;
+
+    stats.framesReceived++;
+    if (packet->wireLength > packet->getData().length) {
+        stats.truncated++;
+    }
 
     // Go through all sniffers and testing packet
     // One packet can be validated in more sniffers - depends on sniffer level (HTTP uses IP etc.)
     for (pos = sniffers.begin(); pos != sniffers.end(); ++pos) {
         if ((*pos)->validatePacket(*packet)) {
             (*pos)->callCallback(packet);               // calling callback
+
+            // latency from capture to callback completion, packets without
+            // capture timestamp (not from pcap) are not measured
+            if (packet->timestamp.tv_sec) {
+                clock_gettime(CLOCK_REALTIME, &now);
+                delta = int64_t(now.tv_sec - packet->timestamp.tv_sec) * 1000000000
+                    + (now.tv_nsec - packet->timestamp.tv_nsec);
+                (*pos)->latency.record((delta < 0) ? 0 : u_int64_t(delta));
+            }
+
             // some additionals stats
-            _lastCapturedPacketNumber++;
-            _capturedBytes += packet->getData().length;
+            (*pos)->counters.packets++;
+            (*pos)->counters.bytes += packet->getData().length;
+            classified = 1;
         }
     }
+
+    if (!classified) {
+        stats.filtered++;
+    }
+}
+
+/**
+  * Is called after batch of packets has been delivered to callbacks,
+  * releases memory of TLVs decoded by all sniffers in the batch.
+  */
+void Sniffers::batchDone() {
+    vector<Sniffer *>::iterator pos;
+
+    for (pos = sniffers.begin(); pos != sniffers.end(); ++pos) {
+        (*pos)->batchDone();
+    }
+}
+
+/**
+  * Is called periodically from listening loop, exports metrics
+  * and adapts kernel buffer size.
+  */
+void Sniffers::tick() {
+    time_t now = time(NULL);
+
+    if (config.maxBufferSize > 0 && sessionHandle && now >= nextDropsCheck) {
+        adaptBufferSize();
+        nextDropsCheck = now + DROPS_CHECK_INTERVAL;
+    }
+
+    if (!metricsFile.empty() && now >= nextMetricsExport) {
+        writeMetrics(metricsFile);
+        nextMetricsExport = now + metricsInterval;
+    }
+}
+
+/**
+  * Returns time until next metrics export or buffer size check.
+  * @return Time until next scheduled work [ms], -1 when nothing is scheduled.
+  */
+int Sniffers::nextTick() {
+    time_t now = time(NULL), deadline = 0;
+
+    if (config.maxBufferSize > 0) {
+        deadline = nextDropsCheck;
+    }
+
+    if (!metricsFile.empty() && (!deadline || nextMetricsExport < deadline)) {
+        deadline = nextMetricsExport;
+    }
+
+    if (!deadline) {                // nothing scheduled, sleeping until packet arrives
+        return -1;
+    }
+
+    return (deadline > now) ? int(deadline - now) * 1000 : 0;
+}
+
+/**
+  * Doubles kernel buffer (up to configured ceiling) whether kernel dropped
+  * some frames since last check and reopens the session.
+  */
+void Sniffers::adaptBufferSize() {
+    u_int64_t drops;
+    int previous, size;
+
+    updateDrops();
+    drops = stats.kernelDrops - checkedKernelDrops;
+    checkedKernelDrops = stats.kernelDrops;
+
+    previous = (config.bufferSize > 0) ? config.bufferSize : DEFAULT_BUFFER_SIZE;
+    if (!drops || previous >= config.maxBufferSize) {   // nothing lost or ceiling reached
+        return;
+    }
+
+    size = (previous > config.maxBufferSize / 2) ? config.maxBufferSize : previous * 2;
+    cerr << interface << ": kernel dropped " << drops << " frames, capture buffer "
+         << previous / 1024 << " KiB -> " << size / 1024 << " KiB" << endl;
+
+    config.bufferSize = size;
+    if (reopenSession()) {          // going back to the last working size
+        cerr << interface << ": unable reopen session, capture buffer stays "
+             << previous / 1024 << " KiB" << endl;
+        config.bufferSize = previous;
+        config.maxBufferSize = previous;    // do not try it again
+        reopenSession();
+    }
+}
+
+/**
+  * Samples kernel drop counters and closes opened session whether exists.
+  */
+void Sniffers::closeSession() {
+    updateDrops();
+    Sniffer::closeSession();
+    lastKernelDrops = lastInterfaceDrops = 0;   // new session starts from zero
+}
+
+/**
+  * Samples drop counters of capture session into statistics.
+  */
+void Sniffers::updateDrops() {
+    struct pcap_stat pcapStats;
+
+    if (!sessionHandle || pcap_stats(sessionHandle, &pcapStats) == -1) {
+        return;
+    }
+
+    // pcap counters are 32-bit, unsigned difference handles wrapping
+    stats.kernelDrops += u_int32_t(pcapStats.ps_drop - lastKernelDrops);
+    stats.interfaceDrops += u_int32_t(pcapStats.ps_ifdrop - lastInterfaceDrops);
+    lastKernelDrops = pcapStats.ps_drop;
+    lastInterfaceDrops = pcapStats.ps_ifdrop;
 }
 
 /**
@@ -97,6 +347,64 @@ void Sniffers::newPacket(Packet *packet) {
   * @return True on valid stop of sending else false.
   */
 int Sniffers::startSending(int protocol, int ttl, int interval) {
+    time_t now, sent;
+    int timeout, next, packetTtl;
+    string packetInterface;
+    Packet *packet;
+
+    setSchedule(ttl, interval);
+
+    if (!(packet = generatePacket(protocol, packetTtl = sendTtl))) {
+        return ERR_GENPACKET;
+    }
+    packetInterface = interface;
+
+    sending = 1;
+    while (sending) {       // sending
+        // schedule or interface has been reconfigured
+        if (packetTtl != sendTtl || packetInterface != interface) {
+            delete packet;
+            if (!(packet = generatePacket(protocol, packetTtl = sendTtl))) {
+                return ERR_GENPACKET;
+            }
+            packetInterface = interface;
+        }
+
+        if (sendPacket(packet)) {   // sending failed
+            stats.sendErrors++;
+            delete packet;
+            return ERR_SENDPACKET;
+        }
+
+        // packet sent, soma additional statistics
+        stats.sentPackets++;
+        stats.sentBytes += packet->getData().length;
+        tick();
+
+        // sleeping for interval, woken up by events and scheduled work
+        sent = time(NULL);
+        while (sending && (now = time(NULL)) < sent + sendInterval) {
+            timeout = int(sent + sendInterval - now) * 1000;
+            if ((next = nextTick()) >= 0 && next < timeout) {
+                timeout = next;
+            }
+            waitEvents(timeout);
+            tick();
+        }
+    }
+
+    delete packet;
+
+    return 0;
+}
+
+/**
+  * Generates packet of protocol which is sent on interface.
+  * @param protocol Which packet will be generated.
+  * @param ttl Time to live of packet.
+  * @return Generated packet or NULL on failure.
+  */
+Packet *Sniffers::generatePacket(int protocol, int ttl) {
     int ret = 0;
     Packet *packet = 0;
     Data packetData(packet_buff, 0);
@@ -112,64 +420,351 @@ int Sniffers::startSending(int protocol, int ttl, int interval) {
         break;
     }
 
-    if (ret || !packet) {   // no packet generated
+    if (ret) {              // no packet generated
         delete packet;
-        return ERR_GENPACKET;
+        return NULL;
     }
 
-    sending = 1;
-    while (sending) {       // sending
-        if (sendPacket(packet)) {   // sending failed
-            delete packet;
-            return ERR_SENDPACKET;
+    return packet;
+}
+
+/**
+  * Stops sending packets.
+  */
+void Sniffers::stopSending() {
+    sending = 0;
+}
+
+/**
+  * Changes schedule of running (or next) sending. Packet is generated
+  * again before the next sending whether time to live changed.
+  * @param ttl Time to live of packet
+  * @param interval Duration between packet resending.
+  */
+void Sniffers::setSchedule(int ttl, int interval) {
+    sendTtl = ttl;
+    sendInterval = interval;
+}
+
+/**
+  * Passes event to listening or sending loop. Async-signal-safe,
+  * event is handled in the loop, not in the caller context.
+  * @param event Event from enumeration events.
+  */
+void Sniffers::notify(char event) {
+    int savedErrno = errno;         // signal handler must not change errno
+
+    if (eventPipe[1] == -1 || write(eventPipe[1], &event, 1) != 1) {
+        if (event == EVENT_STOP) {  // no pipe or full, at least flags
+            listeningStopped = 1;
+            sending = 0;
         }
+    }
 
-        // packet sent, soma additional statistics
-        _lastSentPacketNumber++;
-        _sentBytes += packet->getData().length;
-        sleep(interval);    // sleeping for interval
+    errno = savedErrno;
+}
+
+/**
+  * Handles events passed by notify().
+  */
+void Sniffers::handleEvents() {
+    char events[64];
+    ssize_t count;
+    int reload = 0;
+
+    while ((count = read(eventPipe[0], events, sizeof(events))) > 0) {
+        for (ssize_t i = 0; i < count; i++) {
+            switch (events[i]) {
+            case EVENT_STOP:
+                stopListening();
+                stopSending();
+                break;
+            case EVENT_RELOAD:      // more reloads in row are done once
+                reload = 1;
+                break;
+            }
+        }
     }
 
-    delete packet;
+    if (reload && reloadCallback) {
+        reloadCallback(*this);
+    }
+}
 
-    return 0;
+/**
+  * Waits for events (and handles them) at most given time.
+  * @param timeout Maximal time of waiting [ms], -1 for infinity.
+  */
+void Sniffers::waitEvents(int timeout) {
+    struct pollfd pollFd;
+
+    pollFd.fd = eventPipe[0];
+    pollFd.events = POLLIN;
+    pollFd.revents = 0;
+
+    // without pipe only sleeping (interrupted by signal)
+    if (poll(&pollFd, (eventPipe[0] != -1) ? 1 : 0, timeout) > 0 && (pollFd.revents & POLLIN)) {
+        handleEvents();
+    }
 }
 
 /**
-  * Stops sending packets.
+  * Returns histogram of capture to callback completion latencies of protocol.
+  * @param protocol Protocol of sniffer (LLDP_PROTOCOL, CDP_PROTOCOL).
+  * @return Latency histogram [ns] or NULL whether no sniffer of protocol is added.
   */
-void Sniffers::stopSending() {
-    sending = 0;
+const LatencyHistogram *Sniffers::latencyHistogram(int protocol) {
+    vector<Sniffer *>::iterator pos;
+
+    for (pos = sniffers.begin(); pos != sniffers.end(); ++pos) {
+        if ((*pos)->protocol == protocol) {
+            return &(*pos)->latency;
+        }
+    }
+
+    return NULL;
 }
 
 /**
-  * Returns last number of captured packet.
-  * @return Number of last captured packet
+  * Returns cache of recently decoded PDUs of protocol.
+  * @param protocol Protocol of sniffer (LLDP_PROTOCOL, CDP_PROTOCOL).
+  * @return Decode cache or NULL whether no sniffer of protocol is added.
   */
-int Sniffers::lastCapturedPacketNumber() {
-    return _lastCapturedPacketNumber;
+const DecodeCache *Sniffers::decodeCache(int protocol) {
+    vector<Sniffer *>::iterator pos;
+
+    for (pos = sniffers.begin(); pos != sniffers.end(); ++pos) {
+        if ((*pos)->protocol == protocol) {
+            return &(*pos)->decodeCache;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+  * Returns number of captured (classified) packets.
+  * @return Number of captured packets
+  */
+u_int64_t Sniffers::capturedPackets() {
+    vector<Sniffer *>::iterator pos;
+    u_int64_t packets = 0;
+
+    for (pos = sniffers.begin(); pos != sniffers.end(); ++pos) {
+        packets += (*pos)->counters.packets;
+    }
+
+    return packets;
 }
 
 /**
   * Returns number of captured bytes.
   * @return Number of captured bytes.
   */
-int Sniffers::capturedBytes() {
-    return _capturedBytes;
+u_int64_t Sniffers::capturedBytes() {
+    vector<Sniffer *>::iterator pos;
+    u_int64_t bytes = 0;
+
+    for (pos = sniffers.begin(); pos != sniffers.end(); ++pos) {
+        bytes += (*pos)->counters.bytes;
+    }
+
+    return bytes;
 }
 
 /**
-  * Returns last number of sent packet.
-  * @return Number of last sent packet
+  * Returns number of sent packets.
+  * @return Number of sent packets
   */
-int Sniffers::lastSentPacketNumber() {
-    return _lastSentPacketNumber;
+u_int64_t Sniffers::sentPackets() {
+    return stats.sentPackets;
 }
 
 /**
   * Returns number of sent bytes.
   * @return Number of sent bytes.
   */
-int Sniffers::sentBytes() {
-    return _sentBytes;
+u_int64_t Sniffers::sentBytes() {
+    return stats.sentBytes;
+}
+
+/**
+  * Returns counters of whole pipeline.
+  * @return Counters of pipeline.
+  */
+const Sniffers::Statistics &Sniffers::statistics() {
+    updateDrops();
+    return stats;
+}
+
+/**
+  * Returns counters of packets of protocol.
+  * @param protocol Protocol of sniffer (LLDP_PROTOCOL, CDP_PROTOCOL).
+  * @return Counters or NULL whether no sniffer of protocol is added.
+  */
+const Packet::Counters *Sniffers::protocolCounters(int protocol) {
+    vector<Sniffer *>::iterator pos;
+
+    for (pos = sniffers.begin(); pos != sniffers.end(); ++pos) {
+        if ((*pos)->protocol == protocol) {
+            return &(*pos)->counters;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+  * Returns name of protocol used in metric labels.
+  * @param protocol Protocol number.
+  * @return Name of protocol.
+  */
+string Sniffers::protocolName(int protocol) {
+    switch (protocol) {
+    case LLDP_PROTOCOL:
+        return "lldp";
+    case CDP_PROTOCOL:
+        return "cdp";
+    default:
+        return "unknown";
+    }
+}
+
+/**
+  * Appends one metric family into Prometheus text.
+  * @param out Output stream.
+  * @param name Name of metric.
+  * @param help Help text of metric.
+  */
+static void metricHeader(ostream &out, const string &name, const string &help) {
+    out << "# HELP " << name << " " << help << "\n";
+    out << "# TYPE " << name << " counter\n";
+}
+
+/**
+  * Sets types of TLVs which are decoded before callback of protocol
+  * is called, TLVs of other types are skipped.
+  * @param protocol Protocol of sniffer (LLDP_PROTOCOL, CDP_PROTOCOL).
+  * @param projection Types of TLVs to be decoded.
+  * @return True on success, false whether no sniffer of protocol is added.
+  */
+int Sniffers::setProjection(int protocol, const Packet::Projection &projection) {
+    vector<Sniffer *>::iterator pos;
+
+    for (pos = sniffers.begin(); pos != sniffers.end(); ++pos) {
+        if ((*pos)->protocol == protocol) {
+            (*pos)->projection = projection;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+  * Sets count of recently decoded PDUs kept by every sniffer, decode()
+  * of packet returns identical announcements found there without reading.
+  * @param entries Count of cached PDUs, 0 disables caching.
+  */
+void Sniffers::setDecodeCache(size_t entries) {
+    vector<Sniffer *>::iterator pos;
+
+    for (pos = sniffers.begin(); pos != sniffers.end(); ++pos) {
+        (*pos)->decodeCache.resize(entries);
+    }
+}
+
+/**
+  * Returns all counters in Prometheus text exposition format.
+  * @return Counters in Prometheus text format.
+  */
+string Sniffers::metrics() {
+    vector<Sniffer *>::iterator pos;
+    const Statistics &global = statistics();
+    const string label = "interface=\"" + interface + "\"";
+    stringstream out;
+    string protocolLabel;
+
+    metricHeader(out, "sniffer_frames_received_total", "Frames passed from capture into pipeline.");
+    out << "sniffer_frames_received_total{" << label << "} " << global.framesReceived << "\n";
+    metricHeader(out, "sniffer_kernel_drops_total", "Frames dropped by kernel due to full capture buffer.");
+    out << "sniffer_kernel_drops_total{" << label << "} " << global.kernelDrops << "\n";
+    metricHeader(out, "sniffer_interface_drops_total", "Frames dropped by network interface or its driver.");
+    out << "sniffer_interface_drops_total{" << label << "} " << global.interfaceDrops << "\n";
+    metricHeader(out, "sniffer_frames_filtered_total", "Frames not classified by any sniffer.");
+    out << "sniffer_frames_filtered_total{" << label << "} " << global.filtered << "\n";
+    metricHeader(out, "sniffer_frames_truncated_total", "Frames truncated by capture snaplen.");
+    out << "sniffer_frames_truncated_total{" << label << "} " << global.truncated << "\n";
+
+    metricHeader(out, "sniffer_frames_classified_total", "Frames classified as protocol.");
+    for (pos = sniffers.begin(); pos != sniffers.end(); ++pos) {
+        out << "sniffer_frames_classified_total{" << label << ",protocol=\"" << protocolName((*pos)->protocol)
+            << "\"} " << (*pos)->counters.packets << "\n";
+    }
+    metricHeader(out, "sniffer_classified_bytes_total", "Bytes of frames classified as protocol.");
+    for (pos = sniffers.begin(); pos != sniffers.end(); ++pos) {
+        out << "sniffer_classified_bytes_total{" << label << ",protocol=\"" << protocolName((*pos)->protocol)
+            << "\"} " << (*pos)->counters.bytes << "\n";
+    }
+    metricHeader(out, "sniffer_malformed_total", "Decoded frames which were malformed or truncated.");
+    for (pos = sniffers.begin(); pos != sniffers.end(); ++pos) {
+        out << "sniffer_malformed_total{" << label << ",protocol=\"" << protocolName((*pos)->protocol)
+            << "\"} " << (*pos)->counters.malformed << "\n";
+    }
+    metricHeader(out, "sniffer_checksum_failures_total", "Frames with bad checksum.");
+    for (pos = sniffers.begin(); pos != sniffers.end(); ++pos) {
+        out << "sniffer_checksum_failures_total{" << label << ",protocol=\"" << protocolName((*pos)->protocol)
+            << "\"} " << (*pos)->counters.checksumFailures << "\n";
+    }
+    metricHeader(out, "sniffer_decode_cache_hits_total", "Decoded frames whose PDU was found among recently decoded ones.");
+    for (pos = sniffers.begin(); pos != sniffers.end(); ++pos) {
+        out << "sniffer_decode_cache_hits_total{" << label << ",protocol=\"" << protocolName((*pos)->protocol)
+            << "\"} " << (*pos)->decodeCache.hits << "\n";
+    }
+    metricHeader(out, "sniffer_decode_cache_misses_total", "Decoded frames whose PDU had to be read.");
+    for (pos = sniffers.begin(); pos != sniffers.end(); ++pos) {
+        out << "sniffer_decode_cache_misses_total{" << label << ",protocol=\"" << protocolName((*pos)->protocol)
+            << "\"} " << (*pos)->decodeCache.misses << "\n";
+    }
+    metricHeader(out, "sniffer_tlvs_decoded_total", "Decoded TLV structures per type.");
+    for (pos = sniffers.begin(); pos != sniffers.end(); ++pos) {
+        protocolLabel = label + ",protocol=\"" + protocolName((*pos)->protocol) + "\"";
+        for (int type = 0; type <= Packet::Counters::MAX_TLV_TYPES; type++) {
+            if ((*pos)->counters.tlvs[type]) {  // only seen types
+                out << "sniffer_tlvs_decoded_total{" << protocolLabel << ",type=\""
+                    << ((type < Packet::Counters::MAX_TLV_TYPES) ? Data::toStr(type) : "other")
+                    << "\"} " << (*pos)->counters.tlvs[type] << "\n";
+            }
+        }
+    }
+
+    metricHeader(out, "sniffer_output_packets_total", "Sent packets.");
+    out << "sniffer_output_packets_total{" << label << "} " << global.sentPackets << "\n";
+    metricHeader(out, "sniffer_output_bytes_total", "Sent bytes.");
+    out << "sniffer_output_bytes_total{" << label << "} " << global.sentBytes << "\n";
+    metricHeader(out, "sniffer_send_errors_total", "Failed sendings of packet.");
+    out << "sniffer_send_errors_total{" << label << "} " << global.sendErrors << "\n";
+
+    return out.str();
+}
+
+/**
+  * Writes counters in Prometheus text format into file. File is replaced
+  * atomically, so it can be read by textfile collector any time.
+  * @param path Path to file.
+  * @return True on success else false.
+  */
+int Sniffers::writeMetrics(const string &path) {
+    const string tmpPath = path + ".tmp";
+    ofstream file(tmpPath.c_str());
+
+    file << metrics();
+    file.close();
+
+    if (file.fail() || rename(tmpPath.c_str(), path.c_str()) == -1) {
+        perror("Unable write metrics");
+        return 0;
+    }
+
+    return 1;
 }
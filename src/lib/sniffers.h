@@ -20,6 +20,9 @@
 #define SNIFFERS_H
 
 #include <vector>
+#include <string>
+#include <ctime>
+#include <cstring>
 
 #include "sniffers/lldp_sniffer.h"
 #include "sniffers/cdp_sniffer.h"
@@ -43,8 +46,40 @@ public:
         ERR_LISTEN_DEVICE   = 4     /**< Unable listen - open error */
     };
 
-    Sniffers():Sniffer(), sending(0), _lastCapturedPacketNumber(-1),
-        _capturedBytes(0), _lastSentPacketNumber(-1), _sentBytes(0) {}
+    /**
+      * Counters of whole pipeline. Counters of single protocols
+      * are held by corresponding sniffers.
+      */
+    struct Statistics {
+        Statistics() { memset(this, 0, sizeof(*this)); }
+
+        u_int64_t framesReceived;       /**< Frames passed from capture into pipeline */
+        u_int64_t kernelDrops;          /**< Frames dropped by kernel (no room in buffer) */
+        u_int64_t interfaceDrops;       /**< Frames dropped by interface or its driver */
+        u_int64_t filtered;             /**< Frames which has not been classified by any sniffer */
+        u_int64_t truncated;            /**< Frames truncated by snaplen */
+        u_int64_t sentPackets;          /**< Sent packets */
+        u_int64_t sentBytes;            /**< Sent bytes */
+        u_int64_t sendErrors;           /**< Failed sendings of packet */
+    };
+
+    static const int DEFAULT_METRICS_INTERVAL = 10;     /**< Default interval of metrics export [s] */
+    static const int DROPS_CHECK_INTERVAL = 5;          /**< Interval of sampling kernel drops [s] */
+
+    /**
+      * Events which can be passed to running loop by notify().
+      */
+    enum events {
+        EVENT_STOP          = 's',  /**< Stop listening and sending */
+        EVENT_RELOAD        = 'r'   /**< Reload configuration */
+    };
+
+    /**
+      * Type of function called on reload event.
+      */
+    typedef void(*ReloadCallback)(Sniffers &);
+
+    Sniffers();
     ~Sniffers();
 
     /**
@@ -81,42 +116,210 @@ public:
     void stopSending();
 
     /**
-      * Returns last number of captured packet.
-      * @return Number of last captured packet
+      * Changes schedule of running (or next) sending. Packet is generated
+      * again before the next sending whether time to live changed.
+      * @param ttl Time to live of packet
+      * @param interval Duration between packet resending.
+      */
+    void setSchedule(int ttl, int interval);
+
+    /**
+      * Applies new capture settings. Opened session is kept whether interface
+      * and session settings are unchanged, when only filter differs just new
+      * filter is installed. On failure the previous settings are restored.
+      * @param interface Name of interface.
+      * @param config Capture settings.
+      * @param captureFilter Additional filter restricting captured frames, empty for none.
+      * @return True on valid reconfiguration else false.
+      */
+    int reconfigure(const string &interface, const CaptureConfig &config, const string &captureFilter);
+
+    /**
+      * Passes event to listening or sending loop. Async-signal-safe,
+      * event is handled in the loop, not in the caller context.
+      * @param event Event from enumeration events.
+      */
+    void notify(char event);
+
+    ReloadCallback reloadCallback;  /**< Function called on reload event, NULL for none */
+    string captureFilter;           /**< Additional filter restricting captured frames, empty for none */
+
+    /**
+      * Returns number of captured (classified) packets.
+      * @return Number of captured packets
       */
-    int lastCapturedPacketNumber();
+    u_int64_t capturedPackets();
 
     /**
       * Returns number of captured bytes.
       * @return Number of captured bytes.
       */
-    int capturedBytes();
+    u_int64_t capturedBytes();
 
     /**
-      * Returns last number of sent packet.
-      * @return Number of last sent packet
+      * Returns number of sent packets.
+      * @return Number of sent packets
       */
-    int lastSentPacketNumber();
+    u_int64_t sentPackets();
 
     /**
       * Returns number of sent bytes.
       * @return Number of sent bytes.
       */
-    int sentBytes();
+    u_int64_t sentBytes();
+
+    /**
+      * Returns counters of whole pipeline.
+      * @return Counters of pipeline.
+      */
+    const Statistics &statistics();
+
+    /**
+      * Returns counters of packets of protocol.
+      * @param protocol Protocol of sniffer (LLDP_PROTOCOL, CDP_PROTOCOL).
+      * @return Counters or NULL whether no sniffer of protocol is added.
+      */
+    const Packet::Counters *protocolCounters(int protocol);
+
+    /**
+      * Sets types of TLVs which are decoded before callback of protocol
+      * is called, TLVs of other types are skipped.
+      * @param protocol Protocol of sniffer (LLDP_PROTOCOL, CDP_PROTOCOL).
+      * @param projection Types of TLVs to be decoded.
+      * @return True on success, false whether no sniffer of protocol is added.
+      */
+    int setProjection(int protocol, const Packet::Projection &projection);
+
+    /**
+      * Sets count of recently decoded PDUs kept by every sniffer, decode()
+      * of packet returns identical announcements found there without reading.
+      * @param entries Count of cached PDUs, 0 disables caching.
+      */
+    void setDecodeCache(size_t entries);
+
+    /**
+      * Returns all counters in Prometheus text exposition format.
+      * @return Counters in Prometheus text format.
+      */
+    string metrics();
+
+    /**
+      * Writes counters in Prometheus text format into file. File is replaced
+      * atomically, so it can be read by textfile collector any time.
+      * @param path Path to file.
+      * @return True on success else false.
+      */
+    int writeMetrics(const string &path);
+
+    string metricsFile;             /**< File where metrics are periodically exported, empty for none */
+    int metricsInterval;            /**< Interval of metrics export [s] */
+
+    /**
+      * Returns histogram of capture to callback completion latencies of protocol.
+      * @param protocol Protocol of sniffer (LLDP_PROTOCOL, CDP_PROTOCOL).
+      * @return Latency histogram [ns] or NULL whether no sniffer of protocol is added.
+      */
+    const LatencyHistogram *latencyHistogram(int protocol);
+
+    /**
+      * Returns cache of recently decoded PDUs of protocol.
+      * @param protocol Protocol of sniffer (LLDP_PROTOCOL, CDP_PROTOCOL).
+      * @return Decode cache or NULL whether no sniffer of protocol is added.
+      */
+    const DecodeCache *decodeCache(int protocol);
 
-private:
     /**
       * Is called when new packet is captured during listening.
+      * Public so that captured frames can be also injected from memory
+      * (e.g. throughput benchmark) without any pcap session.
       * @param packet Captured packet.
       */
     virtual void newPacket(Packet *packet);
 
+    /**
+      * Is called after batch of packets has been delivered to callbacks,
+      * releases memory of TLVs decoded by all sniffers in the batch.
+      */
+    virtual void batchDone();
+
+protected:
+    /**
+      * Is called periodically from listening loop, exports metrics
+      * and adapts kernel buffer size.
+      */
+    virtual void tick();
+
+    /**
+      * Returns time until next metrics export or buffer size check.
+      * @return Time until next scheduled work [ms], -1 when nothing is scheduled.
+      */
+    virtual int nextTick();
+
+    /**
+      * Handles events passed by notify().
+      */
+    virtual void handleEvents();
+
+    /**
+      * Samples kernel drop counters and closes opened session whether exists.
+      */
+    virtual void closeSession();
+
+private:
+    /**
+      * Samples drop counters of capture session into statistics.
+      */
+    void updateDrops();
+
+    /**
+      * Doubles kernel buffer (up to configured ceiling) whether kernel dropped
+      * some frames since last check and reopens the session.
+      */
+    void adaptBufferSize();
+
+    /**
+      * Waits for events (and handles them) at most given time.
+      * @param timeout Maximal time of waiting [ms], -1 for infinity.
+      */
+    void waitEvents(int timeout);
+
+    /**
+      * Creates filter of session from filters of all sniffers and capture filter.
+      * @return Filter of session.
+      */
+    string buildFilter();
+
+    /**
+      * Keys decode caches of all sniffers by current interface.
+      */
+    void keyDecodeCaches();
+
+    /**
+      * Generates packet of protocol which is sent on interface.
+      * @param protocol Which packet will be generated.
+      * @param ttl Time to live of packet.
+      * @return Generated packet or NULL on failure.
+      */
+    Packet *generatePacket(int protocol, int ttl);
+
+    /**
+      * Returns name of protocol used in metric labels.
+      * @param protocol Protocol number.
+      * @return Name of protocol.
+      */
+    static string protocolName(int protocol);
+
     vector<Sniffer *> sniffers;     /**< Array with demanded sniffers */
-    int sending;                    /**< Signalizes whether is currently sending */
-    int _lastCapturedPacketNumber;  /**< Last captured packet number */
-    int _capturedBytes;             /**< Total captured bytes */
-    int _lastSentPacketNumber;      /**< Last sent packet number */
-    int _sentBytes;                 /**< Total sent bytes */
+    volatile int sending;           /**< Signalizes whether is currently sending */
+    int sendTtl;                    /**< Time to live of sent packets */
+    int sendInterval;               /**< Duration between packet resending [s] */
+    Statistics stats;               /**< Counters of whole pipeline */
+    u_int32_t lastKernelDrops;      /**< Last sampled kernel drops of current session */
+    u_int32_t lastInterfaceDrops;   /**< Last sampled interface drops of current session */
+    u_int64_t checkedKernelDrops;   /**< Kernel drops at last buffer size check */
+    time_t nextMetricsExport;       /**< Time of next metrics export */
+    time_t nextDropsCheck;          /**< Time of next buffer size check */
+    int eventPipe[2];               /**< Self-pipe for passing events from signal handlers */
 };
 
 #endif
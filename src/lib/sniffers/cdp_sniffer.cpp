@@ -39,6 +39,11 @@ int CDPSniffer::validatePacket(Packet &packet) {
   */
 void CDPSniffer::callCallback(Packet *packet) {
     CDPPacket *detailedPacket = new CDPPacket(packet->getData(), packet->protocols);
+    detailedPacket->copyCaptureInfo(*packet);
+    detailedPacket->counters = &counters;
+    detailedPacket->arena = &arena;
+    detailedPacket->projection = &projection;
+    detailedPacket->decodeCache = &decodeCache;
 
     if (captureCallback) captureCallback(detailedPacket);
 
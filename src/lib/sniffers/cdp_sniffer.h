@@ -21,6 +21,7 @@
 #include <string>
 
 #include "packets/cdp_packet.h"
+#include "packets/protocols.h"
 #include "sniffer.h"
 
 /**
@@ -42,7 +43,7 @@ public:
     /**
       * Constructor
       */
-    CDPSniffer():Sniffer(FILTER) {}
+    CDPSniffer():Sniffer(FILTER, CDP_PROTOCOL) {}
 
     /**
       * Validate sniffed packet.
@@ -0,0 +1,284 @@
+/*******************************************************************************
+ * Projekt:         Programování síťové služby: Sniffer CDP a LLDP
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Modul definující mezipaměť naposledy dekódovaných PDU.
+ *
+ ******************************************************************************/
+
+/**
+ * @file decode_cache.cpp
+ *
+ * @brief Module which defines cache of recently decoded PDUs.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include "decode_cache.h"
+
+/**
+  * Primes of XXH64, composed of halves (long long literals are not C++98).
+  */
+static const u_int64_t PRIME64_1 = (u_int64_t(0x9E3779B1) << 32) | 0x85EBCA87;
+static const u_int64_t PRIME64_2 = (u_int64_t(0xC2B2AE3D) << 32) | 0x27D4EB4F;
+static const u_int64_t PRIME64_3 = (u_int64_t(0x165667B1) << 32) | 0x9E3779F9;
+static const u_int64_t PRIME64_4 = (u_int64_t(0x85EBCA77) << 32) | 0xC2B2AE63;
+static const u_int64_t PRIME64_5 = (u_int64_t(0x27D4EB2F) << 32) | 0x165667C5;
+
+/**
+  * Rotates value to the left.
+  * @param value Rotated value.
+  * @param bits Count of bits, 1 - 63.
+  * @return Rotated value.
+  */
+static inline u_int64_t rotl(u_int64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+/**
+  * Mixes 8 B of input into lane.
+  * @param lane Accumulator of lane.
+  * @param input Input word.
+  * @return New accumulator.
+  */
+static inline u_int64_t mixLane(u_int64_t lane, u_int64_t input) {
+    return rotl(lane + input * PRIME64_2, 31) * PRIME64_1;
+}
+
+/**
+  * Reads unaligned 8 B word in host byte order.
+  * @param data Bytes.
+  * @return Word.
+  */
+static inline u_int64_t read64(const u_int8_t *data) {
+    u_int64_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+/**
+  * Reads unaligned 4 B word in host byte order.
+  * @param data Bytes.
+  * @return Word.
+  */
+static inline u_int32_t read32(const u_int8_t *data) {
+    u_int32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+/**
+  * Constructor.
+  * @param capacity Count of cached PDUs, 0 disables cache.
+  */
+DecodeCache::DecodeCache(size_t capacity):hits(0), misses(0), capacity(0), entries(NULL),
+    remembered(0), seed(0), clock(0), current(0) {
+    resize(capacity);
+}
+
+DecodeCache::~DecodeCache() {
+    delete[] entries;
+}
+
+/**
+  * Returns 64-bit fingerprint of bytes (XXH64 algorithm, words are read
+  * in host byte order). Four independent lanes are mixed per 32 B.
+  * @param data Bytes.
+  * @param length Count of bytes.
+  * @param seed Key of fingerprint.
+  * @return Fingerprint of bytes.
+  */
+u_int64_t DecodeCache::fingerprint(const u_int8_t *data, size_t length, u_int64_t seed) {
+    const u_int8_t *end = data + length;
+    u_int64_t hash, lanes[4];
+
+    if (length >= 32) {
+        lanes[0] = seed + PRIME64_1 + PRIME64_2;
+        lanes[1] = seed + PRIME64_2;
+        lanes[2] = seed;
+        lanes[3] = seed - PRIME64_1;
+
+        // lanes do not depend on each other, they are computed in parallel
+        for (; data + 32 <= end; data += 32) {
+            lanes[0] = mixLane(lanes[0], read64(data));
+            lanes[1] = mixLane(lanes[1], read64(data + 8));
+            lanes[2] = mixLane(lanes[2], read64(data + 16));
+            lanes[3] = mixLane(lanes[3], read64(data + 24));
+        }
+
+        hash = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) + rotl(lanes[3], 18);
+        for (int i = 0; i < 4; i++) {
+            hash = (hash ^ mixLane(0, lanes[i])) * PRIME64_1 + PRIME64_4;
+        }
+    } else {
+        hash = seed + PRIME64_5;
+    }
+
+    hash += length;
+
+    // tail shorter than 32 B
+    for (; data + 8 <= end; data += 8) {
+        hash = rotl(hash ^ mixLane(0, read64(data)), 27) * PRIME64_1 + PRIME64_4;
+    }
+    if (data + 4 <= end) {
+        hash = rotl(hash ^ (u_int64_t(read32(data)) * PRIME64_1), 23) * PRIME64_2 + PRIME64_3;
+        data += 4;
+    }
+    for (; data < end; data++) {
+        hash = rotl(hash ^ (*data * PRIME64_5), 11) * PRIME64_1;
+    }
+
+    // final avalanche
+    hash = (hash ^ (hash >> 33)) * PRIME64_2;
+    hash = (hash ^ (hash >> 29)) * PRIME64_3;
+    return hash ^ (hash >> 32);
+}
+
+/**
+  * Sets ingress interface which keys fingerprints. PDUs cached
+  * for other interface are not found any more.
+  * @param interface Name of interface.
+  */
+void DecodeCache::setInterface(const string &interface) {
+    seed = fingerprint((const u_int8_t *)interface.data(), interface.length(), 0);
+}
+
+/**
+  * Changes count of cached PDUs, all entries are dropped.
+  * @param capacity Count of cached PDUs, 0 disables cache.
+  */
+void DecodeCache::resize(size_t capacity) {
+    delete[] entries;
+
+    this->capacity = capacity;
+    entries = (capacity) ? new Entry[capacity] : NULL;
+    fingerprints.assign(capacity, 0);
+    stamps.assign(capacity, 0);
+    candidates.assign(capacity * CANDIDATE_BITS / 32, 0);
+    remembered = 0;
+    clock = 0;
+}
+
+/**
+  * Looks up entry with identical PDU decoded by the same projection.
+  * @param data Data of frame.
+  * @param begin Start of PDU in data.
+  * @param projection Projection of packet, NULL for all types.
+  * @return Found entry or NULL.
+  */
+DecodeCache::Entry *DecodeCache::find(const Data &data, int begin, const Packet::Projection *projection) {
+    const Packet::Projection all;
+    int length = data.length - begin;
+    Entry *entry;
+
+    if (!projection) {
+        projection = &all;
+    }
+
+    current = fingerprint(data.data + begin, length, seed);
+
+    for (size_t i = 0; i < capacity; i++) {
+        if (fingerprints[i] != current) {
+            continue;
+        }
+
+        // bytes are compared as well, colliding PDU must not get foreign TLVs
+        entry = &entries[i];
+        if (stamps[i] && int(entry->frame.size()) - entry->begin == length
+            && !memcmp(&entry->frame[entry->begin], data.data + begin, length)
+            && !memcmp(entry->projection.mask, projection->mask, sizeof(projection->mask))) {
+            stamps[i] = ++clock;
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+  * Decides whether PDU of the last lookup is cached. PDU is admitted
+  * when its fingerprint has been remembered by admission filter (two
+  * bits of Bloom filter), otherwise it is remembered. Filter is cleared
+  * after CANDIDATES_RATIO PDUs per entry, so PDUs admitted are those
+  * repeated in the meantime.
+  * @return True whether PDU has to be cached.
+  */
+int DecodeCache::admit() {
+    size_t bits = candidates.size() * 32;
+    size_t first = size_t(current % bits), second = size_t((current >> 32) % bits);
+
+    if ((candidates[first / 32] >> (first % 32)) & (candidates[second / 32] >> (second % 32)) & 1) {
+        return 1;
+    }
+
+    candidates[first / 32] |= u_int32_t(1) << (first % 32);
+    candidates[second / 32] |= u_int32_t(1) << (second % 32);
+
+    if (++remembered >= capacity * CANDIDATES_RATIO) {     // aging, only recent PDUs are remembered
+        candidates.assign(candidates.size(), 0);
+        remembered = 0;
+    }
+
+    return 0;
+}
+
+/**
+  * Copies frame into least recently used entry.
+  * @param data Data of frame.
+  * @param begin Start of PDU in data.
+  * @param projection Projection of packet, NULL for all types.
+  * @return Entry to be decoded.
+  */
+DecodeCache::Entry *DecodeCache::store(const Data &data, int begin, const Packet::Projection *projection) {
+    size_t victim = 0;
+    Entry *entry;
+
+    for (size_t i = 1; i < capacity && stamps[victim]; i++) {
+        if (stamps[i] < stamps[victim]) {
+            victim = i;
+        }
+    }
+
+    entry = &entries[victim];
+    entry->tlvs.clear();            // TLVs point into frame which is replaced
+    entry->arena.reset();
+    entry->frame.assign(data.data, data.data + data.length);
+    entry->begin = begin;
+    entry->projection = (projection) ? *projection : Packet::Projection();
+    stamps[victim] = ++clock;
+    fingerprints[victim] = current;
+
+    return entry;
+}
+
+/**
+  * Moves counters of decoding of entry from scratch counters into entry.
+  * @param entry Decoded entry.
+  */
+void DecodeCache::record(Entry &entry) {
+    entry.types.clear();
+    for (int type = 0; type <= Packet::Counters::MAX_TLV_TYPES; type++) {
+        for (; scratch.tlvs[type]; scratch.tlvs[type]--) {
+            entry.types.push_back(type);
+        }
+    }
+    entry.malformed = scratch.malformed != 0;
+    scratch.malformed = 0;
+}
+
+/**
+  * Updates counters the same as decoding of entry did.
+  * @param entry Decoded entry.
+  * @param counters Counters to be updated, NULL when not counted.
+  */
+void DecodeCache::replay(const Entry &entry, Packet::Counters *counters) {
+    if (!counters) {
+        return;
+    }
+
+    for (size_t i = 0; i < entry.types.size(); i++) {
+        counters->tlvs[entry.types[i]]++;
+    }
+    counters->malformed += entry.malformed;
+}
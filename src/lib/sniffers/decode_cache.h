@@ -0,0 +1,199 @@
+/*******************************************************************************
+ * Projekt:         Programování síťové služby: Sniffer CDP a LLDP
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Hlavičkový soubor deklarující mezipaměť naposledy
+ *                  dekódovaných PDU, opakovaná oznámení nejsou znovu čtena.
+ *
+ ******************************************************************************/
+
+/**
+ * @file decode_cache.h
+ *
+ * @brief Header file which declares cache of recently decoded PDUs. Periodic
+ *        re-announcements are recognized by fingerprint of PDU and their
+ *        TLVs are not read again.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef DECODE_CACHE_H
+#define DECODE_CACHE_H
+
+#include <sys/types.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "packets/packet.h"
+#include "packets/tlv.h"
+#include "packets/tlv_arena.h"
+
+using namespace std;
+
+/**
+  * Small LRU cache of decoded PDUs of one protocol. PDU (bytes behind
+  * beginAt() of packet) is looked up by 64-bit fingerprint keyed with
+  * ingress interface, on hit the TLVs decoded from identical PDU before
+  * are returned. Entries keep own copy of frame, so returned TLVs stay
+  * valid until the next call of decode(). PDU is admitted into cache
+  * when it is seen for the second time, so that unique PDUs do not
+  * evict repeated announcements.
+  */
+class DecodeCache {
+public:
+    static const size_t DEFAULT_CAPACITY = 64;  /**< Default count of cached PDUs */
+    static const size_t CANDIDATE_BITS = 64;    /**< Bits of admission filter per entry */
+    static const size_t CANDIDATES_RATIO = 4;   /**< PDUs remembered by filter per entry before it is cleared */
+
+    /**
+      * Constructor.
+      * @param capacity Count of cached PDUs, 0 disables cache.
+      */
+    DecodeCache(size_t capacity = DEFAULT_CAPACITY);
+    ~DecodeCache();
+
+    /**
+      * Returns 64-bit fingerprint of bytes (XXH64 algorithm, words are read
+      * in host byte order). Four independent lanes are mixed per 32 B.
+      * @param data Bytes.
+      * @param length Count of bytes.
+      * @param seed Key of fingerprint.
+      * @return Fingerprint of bytes.
+      */
+    static u_int64_t fingerprint(const u_int8_t *data, size_t length, u_int64_t seed);
+
+    /**
+      * Returns TLVs of packet decoded from identical PDU before. PDU which
+      * is not cached but admitted is decoded into least recently used entry.
+      * Counters of packet are updated the same as by readPacket().
+      * @param packet Packet of protocol (LLDPPacket, CDPPacket).
+      * @return Decoded TLVs, NULL whether packet has to be read by caller
+      *         (cache is disabled, PDU is seen first time or packet has no PDU).
+      */
+    template<class PacketType>
+    const TLVs *decode(const PacketType &packet) {
+        const Data data = packet.getData();
+        int begin = packet.beginAt();
+        Entry *entry;
+
+        if (!capacity || begin <= 0 || begin >= data.length) {
+            return NULL;
+        }
+
+        if ((entry = find(data, begin, packet.projection)) == NULL) {
+            misses++;
+            if (!admit()) {
+                return NULL;
+            }
+
+            entry = store(data, begin, packet.projection);
+
+            // decoding from copy of frame into arena of entry
+            PacketType copy(Data(&entry->frame[0], entry->frame.size()), packet.protocols);
+            copy.arena = &entry->arena;
+            copy.projection = &entry->projection;
+            copy.counters = &scratch;
+            copy.readPacket(entry->tlvs);
+            record(*entry);
+        } else {
+            hits++;
+        }
+
+        replay(*entry, packet.counters);
+
+        return &entry->tlvs;
+    }
+
+    /**
+      * Sets ingress interface which keys fingerprints. PDUs cached
+      * for other interface are not found any more.
+      * @param interface Name of interface.
+      */
+    void setInterface(const string &interface);
+
+    /**
+      * Changes count of cached PDUs, all entries are dropped.
+      * @param capacity Count of cached PDUs, 0 disables cache.
+      */
+    void resize(size_t capacity);
+
+    size_t size() const { return capacity; }    /**< @return Count of cached PDUs */
+
+    u_int64_t hits;             /**< PDUs found in cache */
+    u_int64_t misses;           /**< PDUs not found in cache */
+
+private:
+    DecodeCache(const DecodeCache &);               /**< Non-copyable */
+    DecodeCache &operator=(const DecodeCache &);    /**< Non-copyable */
+
+    /**
+      * Cached PDU with its decoded TLVs.
+      */
+    struct Entry {
+        Entry():begin(0), malformed(0) {}
+
+        vector<u_int8_t> frame;         /**< Copy of frame, TLVs point into it */
+        int begin;                      /**< Start of PDU in frame */
+        Packet::Projection projection;  /**< Types of TLVs which were decoded */
+        vector<u_int8_t> types;         /**< Counted types of TLVs, including skipped ones */
+        int malformed;                  /**< PDU was counted as malformed */
+        TLVArena arena;                 /**< Memory of TLVs, kept for next PDU of entry */
+        TLVs tlvs;                      /**< Decoded TLVs, destructed before arena */
+    };
+
+    /**
+      * Looks up entry with identical PDU decoded by the same projection.
+      * @param data Data of frame.
+      * @param begin Start of PDU in data.
+      * @param projection Projection of packet, NULL for all types.
+      * @return Found entry or NULL.
+      */
+    Entry *find(const Data &data, int begin, const Packet::Projection *projection);
+
+    /**
+      * Decides whether PDU of the last lookup is cached. PDU is admitted
+      * when its fingerprint has been remembered by admission filter (two
+      * bits of Bloom filter), otherwise it is remembered. Filter is cleared
+      * after CANDIDATES_RATIO PDUs per entry, so PDUs admitted are those
+      * repeated in the meantime.
+      * @return True whether PDU has to be cached.
+      */
+    int admit();
+
+    /**
+      * Copies frame into least recently used entry.
+      * @param data Data of frame.
+      * @param begin Start of PDU in data.
+      * @param projection Projection of packet, NULL for all types.
+      * @return Entry to be decoded.
+      */
+    Entry *store(const Data &data, int begin, const Packet::Projection *projection);
+
+    /**
+      * Moves counters of decoding of entry from scratch counters into entry.
+      * @param entry Decoded entry.
+      */
+    void record(Entry &entry);
+
+    /**
+      * Updates counters the same as decoding of entry did.
+      * @param entry Decoded entry.
+      * @param counters Counters to be updated, NULL when not counted.
+      */
+    void replay(const Entry &entry, Packet::Counters *counters);
+
+    size_t capacity;                /**< Count of entries */
+    Entry *entries;                 /**< Cached PDUs */
+    vector<u_int64_t> fingerprints; /**< Fingerprints of entries, scanned on lookup */
+    vector<u_int64_t> stamps;       /**< Stamps of the last use of entries, 0 for empty entry */
+    vector<u_int32_t> candidates;   /**< Admission filter, bits of PDUs seen once */
+    size_t remembered;              /**< PDUs remembered by admission filter */
+    Packet::Counters scratch;       /**< Counters of decoding into entry, zero between decodings */
+    u_int64_t seed;                 /**< Key of ingress interface */
+    u_int64_t clock;                /**< Stamp of the last use */
+    u_int64_t current;              /**< Fingerprint of PDU of the last lookup */
+};
+
+#endif // DECODE_CACHE_H
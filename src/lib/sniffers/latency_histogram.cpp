@@ -0,0 +1,132 @@
+/*******************************************************************************
+ * Projekt:         Programování síťové služby: Sniffer CDP a LLDP
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Modul definující histogram latencí s logaritmicky
+ *                  rozloženými přihrádkami.
+ *
+ ******************************************************************************/
+
+/**
+ * @file latency_histogram.cpp
+ *
+ * @brief Module which defines HDR-style histogram of latencies with
+ *        logarithmically spread buckets.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <cstring>
+#include "latency_histogram.h"
+
+/**
+  * Returns position of the most significant set bit.
+  * @param value Non zero value.
+  * @return Position of the most significant bit.
+  */
+static inline int mostSignificantBit(u_int64_t value) {
+#ifdef __GNUC__
+    return 63 - __builtin_clzll(value);
+#else
+    int bit = 0;
+    while (value >>= 1) bit++;
+    return bit;
+#endif
+}
+
+/**
+  * Records one latency value.
+  * @param value Latency in nanoseconds.
+  */
+void LatencyHistogram::record(u_int64_t value) {
+    buckets[bucketIndex(value)]++;
+    _count++;
+    _sum += value;
+    if (value < _min) _min = value;
+    if (value > _max) _max = value;
+}
+
+/**
+  * Removes all recorded values.
+  */
+void LatencyHistogram::reset() {
+    memset(buckets, 0, sizeof(buckets));
+    _count = _sum = _max = 0;
+    _min = ~u_int64_t(0);
+}
+
+/**
+  * Returns value below which is given percentage of recorded values.
+  * @param percentile Percentile in range 0 - 100.
+  * @return Highest value equivalent to the percentile bucket, 0 when empty.
+  */
+u_int64_t LatencyHistogram::percentile(double percentile) const {
+    u_int64_t wanted, seen = 0, bound;
+
+    if (!_count) {
+        return 0;
+    }
+
+    if (percentile >= 100) {
+        return _max;
+    }
+
+    // count of values which has to be below returned value (at least one)
+    wanted = u_int64_t(percentile / 100 * _count + 0.5);
+    if (!wanted) wanted = 1;
+
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += buckets[i];
+        if (seen >= wanted) {
+            bound = bucketUpperBound(i);
+            return (bound < _max) ? bound : _max;
+        }
+    }
+
+    return _max;
+}
+
+/**
+  * Returns bucket index of value.
+  * Values below SUB_BUCKETS have own bucket, the bigger are split by magnitude
+  * (position of the most significant bit) into SUB_BUCKETS / 2 linear buckets.
+  * @param value Value to be stored.
+  * @return Index of bucket.
+  */
+int LatencyHistogram::bucketIndex(u_int64_t value) {
+    int magnitude, shift;
+
+    if (value < u_int64_t(SUB_BUCKETS)) {
+        return int(value);
+    }
+
+    magnitude = mostSignificantBit(value);
+    if (magnitude >= MAX_VALUE_BITS) {      // clamping to the last bucket
+        return BUCKETS - 1;
+    }
+
+    shift = magnitude - SUB_BUCKET_BITS + 1;
+    return SUB_BUCKETS + (magnitude - SUB_BUCKET_BITS) * (SUB_BUCKETS / 2)
+        + int(value >> shift) - SUB_BUCKETS / 2;
+}
+
+/**
+  * Returns the highest value which falls into bucket.
+  * @param index Index of bucket.
+  * @return The highest value of bucket.
+  */
+u_int64_t LatencyHistogram::bucketUpperBound(int index) {
+    int magnitude, shift, sub;
+
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+
+    index -= SUB_BUCKETS;
+    magnitude = index / (SUB_BUCKETS / 2) + SUB_BUCKET_BITS;
+    sub = index % (SUB_BUCKETS / 2) + SUB_BUCKETS / 2;
+    shift = magnitude - SUB_BUCKET_BITS + 1;
+
+    return ((u_int64_t(sub) + 1) << shift) - 1;
+}
@@ -0,0 +1,104 @@
+/*******************************************************************************
+ * Projekt:         Programování síťové služby: Sniffer CDP a LLDP
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Hlavičkový soubor deklarující histogram latencí
+ *                  s logaritmicky rozloženými přihrádkami.
+ *
+ ******************************************************************************/
+
+/**
+ * @file latency_histogram.h
+ *
+ * @brief Header file which declares HDR-style histogram of latencies with
+ *        logarithmically spread buckets.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <sys/types.h>
+
+/**
+  * Histogram of latencies in nanoseconds. Every power of two range is split
+  * into SUB_BUCKETS / 2 linear buckets, so relative error of any reported
+  * value is below 1 / (SUB_BUCKETS / 2). Recording is constant time and
+  * does not allocate.
+  */
+class LatencyHistogram {
+public:
+    static const int SUB_BUCKET_BITS = 6;                       /**< Bits of linear sub-bucket index */
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;        /**< Count of sub-buckets per magnitude */
+    static const int MAX_VALUE_BITS = 44;                       /**< Values are clamped to 2^44 ns (~4.9 h) */
+    static const int BUCKETS = SUB_BUCKETS + (MAX_VALUE_BITS - SUB_BUCKET_BITS) * (SUB_BUCKETS / 2);
+
+    LatencyHistogram() { reset(); }
+
+    /**
+      * Records one latency value.
+      * @param value Latency in nanoseconds.
+      */
+    void record(u_int64_t value);
+
+    /**
+      * Removes all recorded values.
+      */
+    void reset();
+
+    /**
+      * Returns value below which is given percentage of recorded values.
+      * @param percentile Percentile in range 0 - 100.
+      * @return Highest value equivalent to the percentile bucket, 0 when empty.
+      */
+    u_int64_t percentile(double percentile) const;
+
+    /**
+      * Returns count of recorded values.
+      * @return Count of recorded values.
+      */
+    u_int64_t count() const { return _count; }
+
+    /**
+      * Returns the smallest recorded value.
+      * @return The smallest recorded value, 0 when empty.
+      */
+    u_int64_t min() const { return (_count) ? _min : 0; }
+
+    /**
+      * Returns the biggest recorded value.
+      * @return The biggest recorded value.
+      */
+    u_int64_t max() const { return _max; }
+
+    /**
+      * Returns arithmetic mean of recorded values.
+      * @return Mean of recorded values, 0 when empty.
+      */
+    double mean() const { return (_count) ? double(_sum) / _count : 0; }
+
+private:
+    /**
+      * Returns bucket index of value.
+      * @param value Value to be stored.
+      * @return Index of bucket.
+      */
+    static int bucketIndex(u_int64_t value);
+
+    /**
+      * Returns the highest value which falls into bucket.
+      * @param index Index of bucket.
+      * @return The highest value of bucket.
+      */
+    static u_int64_t bucketUpperBound(int index);
+
+    u_int64_t buckets[BUCKETS];     /**< Counts of values in buckets */
+    u_int64_t _count;               /**< Count of recorded values */
+    u_int64_t _sum;                 /**< Sum of recorded values */
+    u_int64_t _min;                 /**< The smallest recorded value */
+    u_int64_t _max;                 /**< The biggest recorded value */
+};
+
+#endif // LATENCY_HISTOGRAM_H
@@ -39,6 +39,11 @@ int LLDPSniffer::validatePacket(Packet &packet) {
   */
 void LLDPSniffer::callCallback(Packet *packet) {
     LLDPPacket *detailedPacket = new LLDPPacket(packet->getData(), packet->protocols);
+    detailedPacket->copyCaptureInfo(*packet);
+    detailedPacket->counters = &counters;
+    detailedPacket->arena = &arena;
+    detailedPacket->projection = &projection;
+    detailedPacket->decodeCache = &decodeCache;
 
     if (captureCallback) captureCallback(detailedPacket);
 
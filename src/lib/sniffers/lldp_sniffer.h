@@ -20,6 +20,7 @@
 
 #include <string>
 #include "packets/lldp_packet.h"
+#include "packets/protocols.h"
 #include "sniffer.h"
 
 /**
@@ -41,7 +42,7 @@ public:
     /**
       * Constructor
       */
-    LLDPSniffer():Sniffer(FILTER) {}
+    LLDPSniffer():Sniffer(FILTER, LLDP_PROTOCOL) {}
 
     /**
       * Validate sniffed packet.
@@ -0,0 +1,311 @@
+/*******************************************************************************
+ * Projekt:         Programování síťové služby: Sniffer CDP a LLDP
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Modul definující tabulku sousedů sestavenou ze zachycených
+ *                  LLDP a CDP paketů.
+ *
+ ******************************************************************************/
+
+/**
+ * @file neighbor_table.cpp
+ *
+ * @brief Module which defines table of neighbors built from captured LLDP
+ *        and CDP packets.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include "packets/protocols.h"
+#include "packets/lldp_packet.h"
+#include "packets/cdp_packet.h"
+#include "neighbor_table.h"
+
+/**
+  * Record has to fit into one cache line.
+  */
+typedef char RecordFitsCacheLine[(sizeof(NeighborRecord) <= size_t(NeighborTable::CACHE_LINE)) ? 1 : -1];
+
+NeighborTable::NeighborTable():records(allocate(MIN_CAPACITY)), capacity(MIN_CAPACITY), count(0), lastExpiry(0) {
+}
+
+/**
+  * Destructor, strings are freed together with pool.
+  */
+NeighborTable::~NeighborTable() {
+    free(records);
+}
+
+/**
+  * Allocates empty and aligned array of records.
+  * @param slots Count of records.
+  * @return Array of records.
+  */
+NeighborRecord *NeighborTable::allocate(size_t slots) {
+    void *memory;
+
+    if (posix_memalign(&memory, CACHE_LINE, slots * sizeof(NeighborRecord))) {
+        throw bad_alloc();
+    }
+
+    memset(memory, 0, slots * sizeof(NeighborRecord));     // NULL chassis ID marks empty slot
+    return static_cast<NeighborRecord *>(memory);
+}
+
+/**
+  * Returns 64-bit FNV-1a hash of key of neighbor.
+  * @param protocol Protocol of neighbor.
+  * @param chassisID Chassis ID.
+  * @param portID Port ID.
+  * @return Hash of key.
+  */
+u_int64_t NeighborTable::hashKey(int protocol, const Data &chassisID, const Data &portID) {
+    // 64-bit constants composed of halves, long long literals are not C++98
+    static const u_int64_t PRIME = (u_int64_t(0x100) << 32) | 0x1b3;
+    u_int64_t value = (u_int64_t(0xcbf29ce4) << 32) | 0x84222325;
+
+    value = (value ^ u_int64_t(protocol)) * PRIME;
+    for (int i = 0; i < chassisID.length; i++) {
+        value = (value ^ chassisID.data[i]) * PRIME;
+    }
+    value = (value ^ u_int64_t(chassisID.length)) * PRIME;     // separates chassis and port ID
+    for (int i = 0; i < portID.length; i++) {
+        value = (value ^ portID.data[i]) * PRIME;
+    }
+
+    return value;
+}
+
+/**
+  * Compares interned string with bytes.
+  * @param str Interned string.
+  * @param value Bytes.
+  * @return True whether are equal.
+  */
+int NeighborTable::equals(const StringPool::String *str, const Data &value) {
+    return str->length() == value.length && (!value.length || !memcmp(str->data(), value.data, value.length));
+}
+
+/**
+  * Updates neighbor by decoded announcement.
+  * @param protocol Protocol of packet (LLDP_PROTOCOL, CDP_PROTOCOL).
+  * @param tlvs Decoded TLVs of packet.
+  * @param ttl Time to live of packet, LLDP time to live TLV takes precedence.
+  * @param now Current time.
+  * @return Result from enumeration updates.
+  */
+int NeighborTable::update(int protocol, const TLVs &tlvs, int ttl, time_t now) {
+    Data chassisID, portID, systemName, systemDescription, platform, portDescription, value;
+    u_int32_t capabilities = 0, interfaceIndex = 0;
+    NeighborDetails *details;
+    NeighborRecord *record;
+    TLVs::const_iterator tlv;
+    u_int64_t hash;
+    size_t slot;
+    int result;
+
+    // picking values of neighbor, strings are not copied yet
+    for (tlv = tlvs.begin(); tlv != tlvs.end(); ++tlv) {
+        value = (*tlv)->getValue();
+
+        if (protocol == LLDP_PROTOCOL) {
+            switch ((*tlv)->tlv_type) {
+            case LLDPPacket::chassisID:             chassisID = value; break;
+            case LLDPPacket::portID:                portID = value; break;
+            case LLDPPacket::portDescription:       portDescription = value; break;
+            case LLDPPacket::systemName:            systemName = value; break;
+            case LLDPPacket::systemDescription:     systemDescription = value; break;
+            case LLDPPacket::timeToLive:
+                if (value.length >= 2) ttl = value.readBE16(0);
+                break;
+            case LLDPPacket::systemCapabilities:    // supported and enabled
+                if (value.length >= 4) capabilities = value.readBE32(0);
+                break;
+            case LLDPPacket::managementAddress:     // interface number behind address
+                if (!interfaceIndex) {
+                    DataCursor cursor(value);
+                    cursor.read(cursor.readU8() + 1);
+                    interfaceIndex = cursor.readBE32();
+                    if (!cursor.ok()) interfaceIndex = 0;
+                }
+                break;
+            }
+        } else {
+            switch ((*tlv)->tlv_type) {
+            case CDPPacket::deviceID:               chassisID = value; break;
+            case CDPPacket::portID:                 portID = value; break;
+            case CDPPacket::systemName:             systemName = value; break;
+            case CDPPacket::softwareVersion:        systemDescription = value; break;
+            case CDPPacket::platform:               platform = value; break;
+            case CDPPacket::capabilities:
+                if (value.length >= 4) capabilities = value.readBE32(0);
+                break;
+            }
+        }
+    }
+
+    if (!chassisID.data || !portID.data) {
+        return NEIGHBOR_INVALID;
+    }
+
+    // probing cluster, strings are compared only on match of whole hash
+    hash = hashKey(protocol, chassisID, portID);
+    for (slot = hash & (capacity - 1); (record = &records[slot])->chassisID; slot = (slot + 1) & (capacity - 1)) {
+        if (record->hash == hash && record->protocol == protocol
+            && equals(record->chassisID, chassisID) && equals(record->portID, portID)) {
+            break;
+        }
+    }
+
+    if (ttl <= 0) {             // neighbor is leaving
+        if (record->chassisID) {
+            remove(slot);
+        }
+        return NEIGHBOR_REMOVED;
+    }
+
+    if (!record->chassisID) {
+        if ((count + 1) * 4 > capacity * 3) {   // load factor at most 3/4
+            grow();
+            for (slot = hash & (capacity - 1); records[slot].chassisID; slot = (slot + 1) & (capacity - 1));
+            record = &records[slot];
+        }
+
+        if (freeDetails.empty()) {
+            slab.push_back(NeighborDetails());
+            freeDetails.push_back(slab.size() - 1);
+        }
+
+        record->details = freeDetails.back();
+        freeDetails.pop_back();
+        memset(&slab[record->details], 0, sizeof(NeighborDetails));
+
+        record->hash = hash;
+        record->protocol = protocol;
+        record->chassisID = pool.intern(chassisID.data, chassisID.length);
+        record->portID = pool.intern(portID.data, portID.length);
+        record->announcements = 0;
+        count++;
+        result = NEIGHBOR_NEW;
+    } else {
+        result = NEIGHBOR_REFRESHED;
+    }
+
+    details = &slab[record->details];
+    if ((assign(details->systemName, systemName) | assign(details->systemDescription, systemDescription)
+        | assign(details->platform, platform) | assign(details->portDescription, portDescription)
+        | (record->capabilities != capabilities) | (record->interfaceIndex != interfaceIndex))
+        && result == NEIGHBOR_REFRESHED) {
+        result = NEIGHBOR_CHANGED;
+    }
+
+    record->capabilities = capabilities;
+    record->interfaceIndex = interfaceIndex;
+    record->ttl = (ttl > 0xFFFF) ? 0xFFFF : ttl;
+    record->expiry = now + record->ttl;
+    record->announcements++;
+
+    return result;
+}
+
+/**
+  * Removes expired neighbors, table is scanned at most once per second.
+  * Only records are read, one cache line per slot.
+  * @param now Current time.
+  * @return Count of removed neighbors.
+  */
+size_t NeighborTable::expire(time_t now) {
+    size_t removed = 0;
+
+    if (now == lastExpiry) {
+        return 0;
+    }
+    lastExpiry = now;
+
+    for (size_t slot = 0; slot < capacity;) {
+        if (records[slot].chassisID && records[slot].expiry < u_int64_t(now)) {
+            remove(slot);       // slot is checked again, next record may be shifted here
+            removed++;
+        } else {
+            slot++;
+        }
+    }
+
+    return removed;
+}
+
+/**
+  * Sets string of neighbor whether differs.
+  * @param field String of neighbor.
+  * @param value New value, NULL data for none.
+  * @return True whether string has changed.
+  */
+int NeighborTable::assign(const StringPool::String *&field, const Data &value) {
+    // usual re-announcement, the same bytes
+    if (field && value.data && equals(field, value)) {
+        return 0;
+    }
+
+    if (!field && !value.data) {
+        return 0;
+    }
+
+    pool.release(field);
+    field = (value.data) ? pool.intern(value.data, value.length) : NULL;
+
+    return 1;
+}
+
+/**
+  * Releases strings and cold fields of neighbor and removes its record,
+  * following records of the same cluster are shifted back.
+  * @param slot Index of record.
+  */
+void NeighborTable::remove(size_t slot) {
+    NeighborDetails &details = slab[records[slot].details];
+    size_t next, home;
+
+    pool.release(records[slot].chassisID);
+    pool.release(records[slot].portID);
+    pool.release(details.systemName);
+    pool.release(details.systemDescription);
+    pool.release(details.platform);
+    pool.release(details.portDescription);
+    freeDetails.push_back(records[slot].details);
+    count--;
+
+    // backward shift, no tombstones are left in clusters
+    for (next = (slot + 1) & (capacity - 1); records[next].chassisID; next = (next + 1) & (capacity - 1)) {
+        home = records[next].hash & (capacity - 1);
+        // record can be moved whether its home slot is not cyclically in (slot, next]
+        if ((slot <= next) ? (home <= slot || home > next) : (home <= slot && home > next)) {
+            records[slot] = records[next];
+            slot = next;
+        }
+    }
+
+    records[slot].chassisID = NULL;
+}
+
+/**
+  * Doubles count of slots and moves records.
+  */
+void NeighborTable::grow() {
+    NeighborRecord *grown = allocate(capacity * 2);
+    size_t slot, mask = capacity * 2 - 1;
+
+    for (size_t i = 0; i < capacity; i++) {
+        if (records[i].chassisID) {
+            for (slot = records[i].hash & mask; grown[slot].chassisID; slot = (slot + 1) & mask);
+            grown[slot] = records[i];
+        }
+    }
+
+    free(records);
+    records = grown;
+    capacity *= 2;
+}
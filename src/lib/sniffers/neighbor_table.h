@@ -0,0 +1,197 @@
+/*******************************************************************************
+ * Projekt:         Programování síťové služby: Sniffer CDP a LLDP
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Hlavičkový soubor deklarující tabulku sousedů sestavenou
+ *                  ze zachycených LLDP a CDP paketů.
+ *
+ ******************************************************************************/
+
+/**
+ * @file neighbor_table.h
+ *
+ * @brief Header file which declares table of neighbors built from captured
+ *        LLDP and CDP packets.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef NEIGHBOR_TABLE_H
+#define NEIGHBOR_TABLE_H
+
+#include <sys/types.h>
+#include <ctime>
+#include <vector>
+
+#include "string_pool.h"
+#include "packets/tlv.h"
+
+using namespace std;
+
+#ifdef __GNUC__
+#define CACHE_LINE_ALIGNED __attribute__((aligned(64)))
+#else
+#define CACHE_LINE_ALIGNED
+#endif
+
+/**
+  * Fields of neighbor which are read by lookup and expiry, held in one
+  * cache line. Record with NULL chassis ID is an empty slot.
+  */
+struct CACHE_LINE_ALIGNED NeighborRecord {
+    u_int64_t hash;                         /**< Hash of protocol, chassis ID and port ID */
+    const StringPool::String *chassisID;    /**< Chassis ID (LLDP) or device ID (CDP) */
+    const StringPool::String *portID;       /**< Port ID */
+    u_int64_t expiry;                       /**< Time when neighbor expires */
+    u_int32_t capabilities;                 /**< Capabilities bit array */
+    u_int32_t interfaceIndex;               /**< Interface number of management address, 0 for none */
+    u_int32_t announcements;                /**< Count of received announcements */
+    u_int32_t details;                      /**< Index of cold fields in slab */
+    u_int16_t ttl;                          /**< Time to live of the last announcement [s] */
+    u_int16_t protocol;                     /**< Protocol of announcements */
+};
+
+/**
+  * Variable length fields of neighbor, read only on output.
+  * Strings are NULL whether were not announced.
+  */
+struct NeighborDetails {
+    const StringPool::String *systemName;           /**< System name */
+    const StringPool::String *systemDescription;    /**< System description (LLDP) or software version (CDP) */
+    const StringPool::String *platform;             /**< Platform (CDP) */
+    const StringPool::String *portDescription;      /**< Port description (LLDP) */
+};
+
+/**
+  * Table of neighbors identified by protocol, chassis (device) ID and port ID.
+  * Records are stored in open addressing hash table with linear probing,
+  * their variable length fields in separate slab. All strings of neighbors
+  * are interned in pool of table, so neighbors of the same model share one
+  * copy of description, platform etc. and can be compared by pointer.
+  */
+class NeighborTable {
+public:
+    static const size_t MIN_CAPACITY = 64;  /**< Initial count of slots, power of two */
+    static const int CACHE_LINE = 64;       /**< Size of cache line [B] */
+
+    /**
+      * Results of update().
+      */
+    enum updates {
+        NEIGHBOR_INVALID    = 0,    /**< Chassis or port ID is missing */
+        NEIGHBOR_NEW        = 1,    /**< Neighbor has been added */
+        NEIGHBOR_CHANGED    = 2,    /**< Some value of neighbor has changed */
+        NEIGHBOR_REFRESHED  = 3,    /**< Announcement is the same, only expiry is moved */
+        NEIGHBOR_REMOVED    = 4     /**< Neighbor announced zero time to live */
+    };
+
+    /**
+      * Iterator over records of neighbors, empty slots are skipped.
+      */
+    class const_iterator {
+    public:
+        const_iterator(const NeighborRecord *record, const NeighborRecord *end):record(record), end(end) { skip(); }
+        const NeighborRecord &operator*() const { return *record; }
+        const NeighborRecord *operator->() const { return record; }
+        const_iterator &operator++() { ++record; skip(); return *this; }
+        bool operator==(const const_iterator &other) const { return record == other.record; }
+        bool operator!=(const const_iterator &other) const { return record != other.record; }
+
+    private:
+        void skip() { while (record != end && !record->chassisID) ++record; }   /**< Moves behind empty slots */
+
+        const NeighborRecord *record;       /**< Current record */
+        const NeighborRecord *end;          /**< Behind the last slot */
+    };
+
+    NeighborTable();
+    ~NeighborTable();
+
+    /**
+      * Updates neighbor by decoded announcement.
+      * @param protocol Protocol of packet (LLDP_PROTOCOL, CDP_PROTOCOL).
+      * @param tlvs Decoded TLVs of packet.
+      * @param ttl Time to live of packet, LLDP time to live TLV takes precedence.
+      * @param now Current time.
+      * @return Result from enumeration updates.
+      */
+    int update(int protocol, const TLVs &tlvs, int ttl, time_t now);
+
+    /**
+      * Removes expired neighbors, table is scanned at most once per second.
+      * @param now Current time.
+      * @return Count of removed neighbors.
+      */
+    size_t expire(time_t now);
+
+    /**
+      * Returns variable length fields of neighbor.
+      * @param record Record of neighbor.
+      * @return Fields of neighbor.
+      */
+    const NeighborDetails &details(const NeighborRecord &record) const { return slab[record.details]; }
+
+    size_t size() const { return count; }                                               /**< @return Count of neighbors */
+    const_iterator begin() const { return const_iterator(records, records + capacity); }        /**< @return The first neighbor */
+    const_iterator end() const { return const_iterator(records + capacity, records + capacity); } /**< @return Behind the last neighbor */
+    const StringPool &strings() const { return pool; }                                  /**< @return Pool of strings */
+
+private:
+    NeighborTable(const NeighborTable &);               /**< Non-copyable */
+    NeighborTable &operator=(const NeighborTable &);    /**< Non-copyable */
+
+    /**
+      * Returns 64-bit FNV-1a hash of key of neighbor.
+      * @param protocol Protocol of neighbor.
+      * @param chassisID Chassis ID.
+      * @param portID Port ID.
+      * @return Hash of key.
+      */
+    static u_int64_t hashKey(int protocol, const Data &chassisID, const Data &portID);
+
+    /**
+      * Compares interned string with bytes.
+      * @param str Interned string.
+      * @param value Bytes.
+      * @return True whether are equal.
+      */
+    static int equals(const StringPool::String *str, const Data &value);
+
+    /**
+      * Sets string of neighbor whether differs.
+      * @param field String of neighbor.
+      * @param value New value, NULL data for none.
+      * @return True whether string has changed.
+      */
+    int assign(const StringPool::String *&field, const Data &value);
+
+    /**
+      * Releases strings and cold fields of neighbor and removes its record,
+      * following records of the same cluster are shifted back.
+      * @param slot Index of record.
+      */
+    void remove(size_t slot);
+
+    /**
+      * Allocates empty and aligned array of records.
+      * @param slots Count of records.
+      * @return Array of records.
+      */
+    static NeighborRecord *allocate(size_t slots);
+
+    /**
+      * Doubles count of slots and moves records.
+      */
+    void grow();
+
+    StringPool pool;                /**< Interned strings of all neighbors */
+    NeighborRecord *records;        /**< Slots of hash table, count is power of two */
+    size_t capacity;                /**< Count of slots */
+    size_t count;                   /**< Count of neighbors */
+    vector<NeighborDetails> slab;   /**< Cold fields of neighbors */
+    vector<u_int32_t> freeDetails;  /**< Unused indexes of slab */
+    time_t lastExpiry;              /**< Time of the last expiry scan */
+};
+
+#endif // NEIGHBOR_TABLE_H
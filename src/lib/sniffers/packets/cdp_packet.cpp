@@ -25,6 +25,7 @@
 #include "protocols.h"
 #include "llc_packet.h"
 #include "cdp_packet.h"
+#include "../decode_cache.h"
 
 class LLCPacket;
 
@@ -61,62 +62,76 @@ const string CDPPacket::DeviceID::tlv_type_str = "Device ID";
 const string CDPPacket::Addresses::tlv_type_str = "Addresses";
 
 /**
-  * Mapping defined protocol types to string representation.
+  * Names of protocol types indexed by protocol type.
   */
-pair<int, string> Addresses_protocol_types_mapping[] = {
-    std::make_pair(CDPPacket::Addresses::NLPID,        "NLPID"),
-    std::make_pair(CDPPacket::Addresses::IEEE802_2,    "802.2")
+const char *const CDPPacket::Addresses::protocol_types_str[] = {
+    /* 0 = */                   NULL,
+    /* NLPID = */               "NLPID",
+    /* IEEE802_2 = */           "802.2"
 };
 
 /**
-  * Initialization of protocol type mapping.
+  * 802.2 protocol (SNAP header with ethernet type) of IPv6.
   */
-const map<int, string> CDPPacket::Addresses::protocol_types_str(
-    Addresses_protocol_types_mapping,
-    Addresses_protocol_types_mapping + sizeof Addresses_protocol_types_mapping / sizeof Addresses_protocol_types_mapping[0]);
+const u_int8_t CDPPacket::Addresses::IPV6_PROTOCOL[IPV6_PROTOCOL_LENGTH] = {0xaa, 0xaa, 0x03, 0x00, 0x00, 0x00, 0x86, 0xdd};
 
 /**
-  * Mapping defined protocols to string representation.
+  * Returns name of protocol.
+  * @param protocol Protocol (for NLPID protocol type).
+  * @return Name of protocol or NULL whether is not defined.
   */
-pair<int, string> Addresses_protocols_mapping[] = {
-    std::make_pair(CDPPacket::Addresses::IP,    "IP")
-};
-
-/**
-  * Initialization of protocol mapping.
-  */
-const map<int, string> CDPPacket::Addresses::protocols_str(
-    Addresses_protocols_mapping,
-    Addresses_protocols_mapping + sizeof Addresses_protocols_mapping / sizeof Addresses_protocols_mapping[0]);
+const char *CDPPacket::Addresses::protocolName(int protocol) {
+    switch (protocol) { // protocols are sparse, table would be mostly empty
+    case IP:
+        return "IP";
+    default:
+        return NULL;
+    }
+}
 
 /**
   * Returns array addresses in string representation.
   * @return Array of address in format "%d address(es) (<addr1>, <addr2>, ...)"
   */
 const string CDPPacket::Addresses::getValueStr() {
+    DataCursor cursor(tlv_value);
+    u_int32_t number = cursor.readBE32();     // getting count of address present in value
+    const u_int8_t *protocol, *address;
     Address addr;
-
-    const u_int8_t *value = tlv_value.data;
-    int number = ntohl(*(u_int32_t *)value); value += 4;        // getting count of address present in value
-
     string result;
 
+    if (!cursor.ok()) {
+        return getMalformedStr();
+    }
+
+    result.reserve(3 * tlv_value.length);   // hex dump is the longest form of addresses
     result = Data::toStr(number) + " address(es) (";
 
+    for (u_int32_t i = 0; i < number; i++) {    // loop until all address are read
+        if (i) result += ", ";
 
-    while (number) {    // loop until all address are read
         // reading addres - char, char, array, short, array
-        addr.protocolType = *value; value++;
-        addr.protocolLength = *value; value++;
-        memcpy(addr.protocol, value, addr.protocolLength); value += addr.protocolLength;
-        addr.addressLength = ntohs(*(u_int16_t *)value); value += 2;
-        memcpy(addr.address, value, addr.addressLength); value += addr.addressLength;
-
-        result += addr.toStr() + ", ";
-        number--;
+        addr.protocolType = cursor.readU8();
+        addr.protocolLength = cursor.readU8();
+        protocol = cursor.read(addr.protocolLength);
+        addr.addressLength = cursor.readBE16();
+        address = cursor.read(addr.addressLength);
+
+        if (!cursor.ok()) {     // count or lengths exceed the value
+            result += "malformed";
+            break;
+        }
+
+        if (addr.protocolLength > Address::MAX_PROTOCOL_LENGTH || addr.addressLength > Address::MAX_ADDRESS_LENGTH) {
+            result += "unknown (hex) - " + Data::arrToHexStr(address, addr.addressLength);
+            continue;
+        }
+
+        memcpy(addr.protocol, protocol, addr.protocolLength);
+        memcpy(addr.address, address, addr.addressLength);
+        result += addr.toStr();
     }
 
-    result.erase(result.length() - 2);
     result += ")";
     return result;
 }
@@ -127,11 +142,13 @@ const string CDPPacket::Addresses::getValueStr() {
   */
 string CDPPacket::Addresses::Address::toStr() {
 
-    // only IP address is supported
+    // only IP and IPv6 addresses are supported
     if ((protocolType == NLPID) && (protocolLength == 1)
         && (*protocol == CDPPacket::Addresses::IP) && (addressLength == 4)) {
-        return Data::toStr(int(address[0])) + "." + Data::toStr(int(address[1])) + "."
-            + Data::toStr(int(address[2])) + "." + Data::toStr(int(address[3]));
+        return Data::ipv4ToStr(address);
+    } else if ((protocolType == IEEE802_2) && (protocolLength == IPV6_PROTOCOL_LENGTH)
+        && !memcmp(protocol, IPV6_PROTOCOL, IPV6_PROTOCOL_LENGTH) && (addressLength == 16)) {
+        return Data::ipv6ToStr(address);
     } else {
         return "unknown (hex) - " + Data::arrToHexStr(address, addressLength);
     }
@@ -148,41 +165,41 @@ const string CDPPacket::PortID::tlv_type_str = "Port ID";
 const string CDPPacket::Capabilities::tlv_type_str = "Capabilities";
 
 /**
-  * Mapping defined capabilities bits to string representation.
+  * Names of capabilities indexed by bit (the least significant first).
   */
-pair<int, string> Capabilities_capabilities_mapping[] = {
-    std::make_pair(CDPPacket::Capabilities::router  ,           "router"),
-    std::make_pair(CDPPacket::Capabilities::transparentBridge,  "transparent bridge"),
-    std::make_pair(CDPPacket::Capabilities::sourceRouteBridge,  "source route bridge"),
-    std::make_pair(CDPPacket::Capabilities::switchL2,           "switch"),
-    std::make_pair(CDPPacket::Capabilities::host,               "host"),
-    std::make_pair(CDPPacket::Capabilities::IGMPCapable,        "IGMP capable"),
-    std::make_pair(CDPPacket::Capabilities::repeater,           "repeater")
+const char *const CDPPacket::Capabilities::capabilities_str[] = {
+    /* router = */              "router",
+    /* transparentBridge = */   "transparent bridge",
+    /* sourceRouteBridge = */   "source route bridge",
+    /* switchL2 = */            "switch",
+    /* host = */                "host",
+    /* IGMPCapable = */         "IGMP capable",
+    /* repeater = */            "repeater"
 };
 
-/**
-  * Initialization of capabilities mapping.
-  */
-const map<int, string> CDPPacket::Capabilities::capabilities_str(
-    Capabilities_capabilities_mapping,
-    Capabilities_capabilities_mapping + sizeof Capabilities_capabilities_mapping / sizeof Capabilities_capabilities_mapping[0]);
-
 /**
   * Returns specified capabilities as a string delimited by comma.
   * @return Capabilities in string representation in format "<cap1>, <cap2>, ..."
   */
 const string CDPPacket::Capabilities::getValueStr() {
-    const int capabilities = ntohl(*(u_int32_t *)tlv_value.data);
-
-    int mask = 0x00000001;  // test mask
+    u_int32_t capabilities;
+    u_int32_t mask = 0x00000001;    // test mask
+    const char *name;
     string result;
 
+    if (tlv_value.length < 4) {
+        return getMalformedStr();
+    }
+
+    capabilities = tlv_value.readBE32(0);
+
     // shifting mask and getting capabilities
     for (int i = 0; i < 32; i++) {
         if (capabilities & mask) {
 
-            if (capabilities_str.find(mask) != capabilities_str.end()) {
-                result += capabilities_str.at(mask) + ", ";
+            if ((name = tableName(capabilities_str, i))) {
+                result += name;
+                result += ", ";
             } else { // string for this capability is not defined
                 result += "(unknown: " + Data::toStr(i) + ". bit is set), ";
             }
@@ -191,7 +208,9 @@ const string CDPPacket::Capabilities::getValueStr() {
         mask <<= 1;
     }
 
-    result.erase(result.length() - 2);
+    if (result.length()) {
+        result.erase(result.length() - 2);  // deleting last comma
+    }
 
     return result;
 }
@@ -216,6 +235,9 @@ const string CDPPacket::Duplex::tlv_type_str = "Duplex";
   * @return Duplex "half" or "full".
   */
 const string CDPPacket::Duplex::getValueStr() {
+    if (tlv_value.length < 1) {
+        return getMalformedStr();
+    }
     return (*tlv_value.data) ? "full": "half";
 }
 
@@ -229,8 +251,11 @@ const string CDPPacket::MTU::tlv_type_str = "MTU";
   * @return Converted numer number to string.
   */
 const string CDPPacket::MTU::getValueStr() {
-    const int mtu_value = ntohl(*(u_int32_t *)tlv_value.data);
-    return Data::toStr(mtu_value);
+    if (tlv_value.length < 4) {
+        return getMalformedStr();
+    }
+
+    return Data::toStr(tlv_value.readBE32(0));
 }
 
 /**
@@ -238,6 +263,203 @@ const string CDPPacket::MTU::getValueStr() {
   */
 const string CDPPacket::SystemName::tlv_type_str = "System name";
 
+/**
+  * Name of VTP management domain type.
+  */
+const string CDPPacket::VTPManagementDomain::tlv_type_str = "VTP management domain";
+
+/**
+  * Name of native VLAN type.
+  */
+const string CDPPacket::NativeVLAN::tlv_type_str = "Native VLAN";
+
+/**
+  * Returns native VLAN of port.
+  * @return VLAN ID or -1 on malformed value.
+  */
+int CDPPacket::NativeVLAN::getVLAN() const {
+    return (tlv_value.length < 2) ? -1 : tlv_value.readBE16(0);
+}
+
+/**
+  * Returns VLAN as a string.
+  * @return Converted VLAN to string.
+  */
+const string CDPPacket::NativeVLAN::getValueStr() {
+    int vlan = getVLAN();
+    return (vlan == -1) ? getMalformedStr() : Data::toStr(vlan);
+}
+
+/**
+  * Name of VoIP VLAN reply type.
+  */
+const string CDPPacket::VoIPVLANReply::tlv_type_str = "VoIP VLAN reply";
+
+/**
+  * Returns VoIP VLAN.
+  * @return VLAN ID or -1 whether is not present.
+  */
+int CDPPacket::VoIPVLANReply::getVLAN() const {
+    return (tlv_value.length < 3) ? -1 : tlv_value.readBE16(1);
+}
+
+/**
+  * Returns VLAN as a string.
+  * @return Converted VLAN to string, "none" whether VLAN is not present.
+  */
+const string CDPPacket::VoIPVLANReply::getValueStr() {
+    int vlan = getVLAN();
+
+    if (tlv_value.length < 1) {
+        return getMalformedStr();
+    }
+
+    return (vlan == -1) ? "none" : Data::toStr(vlan);
+}
+
+/**
+  * Name of VoIP VLAN query type.
+  */
+const string CDPPacket::VoIPVLANQuery::tlv_type_str = "VoIP VLAN query";
+
+/**
+  * Name of power consumption type.
+  */
+const string CDPPacket::PowerConsumption::tlv_type_str = "Power consumption";
+
+/**
+  * Returns consumed power.
+  * @return Power [mW] or -1 on malformed value.
+  */
+int CDPPacket::PowerConsumption::getPower() const {
+    return (tlv_value.length < 2) ? -1 : tlv_value.readBE16(0);
+}
+
+/**
+  * Returns power as a string.
+  * @return Converted power to string in format "%d mW".
+  */
+const string CDPPacket::PowerConsumption::getValueStr() {
+    int power = getPower();
+    return (power == -1) ? getMalformedStr() : Data::toStr(power) + " mW";
+}
+
+/**
+  * Name of trust bitmap type.
+  */
+const string CDPPacket::TrustBitmap::tlv_type_str = "Trust bitmap";
+
+/**
+  * Returns trust bitmap.
+  * @return Bitmap or -1 on malformed value.
+  */
+int CDPPacket::TrustBitmap::getBitmap() const {
+    return (tlv_value.length < 1) ? -1 : tlv_value.readUChar(0);
+}
+
+/**
+  * Returns trust in string representation.
+  * @return Trust "trusted" or "not trusted" and bitmap.
+  */
+const string CDPPacket::TrustBitmap::getValueStr() {
+    int bitmap = getBitmap();
+
+    if (bitmap == -1) {
+        return getMalformedStr();
+    }
+
+    return ((bitmap & extendedTrust) ? "trusted (0x" : "not trusted (0x") + Data::toHex(u_int8_t(bitmap)) + ")";
+}
+
+/**
+  * Name of untrusted port CoS type.
+  */
+const string CDPPacket::UntrustedCoS::tlv_type_str = "Untrusted port CoS";
+
+/**
+  * Returns CoS applied to frames of untrusted port.
+  * @return CoS or -1 on malformed value.
+  */
+int CDPPacket::UntrustedCoS::getCoS() const {
+    return (tlv_value.length < 1) ? -1 : tlv_value.readUChar(0);
+}
+
+/**
+  * Returns CoS as a string.
+  * @return Converted CoS to string.
+  */
+const string CDPPacket::UntrustedCoS::getValueStr() {
+    int cos = getCoS();
+    return (cos == -1) ? getMalformedStr() : Data::toStr(cos);
+}
+
+/**
+  * Name of management addresses type.
+  */
+const string CDPPacket::ManagementAddresses::tlv_type_str = "Management addresses";
+
+/**
+  * Name of location type.
+  */
+const string CDPPacket::Location::tlv_type_str = "Location";
+
+/**
+  * Returns location without format octet.
+  * @return Location data, empty on malformed value.
+  */
+Data CDPPacket::Location::getLocation() const {
+    return (tlv_value.length < 1) ? Data() : Data(&tlv_value.data[1], tlv_value.length - 1);
+}
+
+/**
+  * Returns location string.
+  * @return Location without format octet.
+  */
+const string CDPPacket::Location::getValueStr() {
+    Data location = getLocation();
+
+    if (tlv_value.length < 1) {
+        return getMalformedStr();
+    }
+
+    return string((const char *)location.data, location.length);
+}
+
+/**
+  * Name of power available type.
+  */
+const string CDPPacket::PowerAvailable::tlv_type_str = "Power available";
+
+/**
+  * Reads available power.
+  * @param power Struct where is value stored.
+  * @return True on success, false on malformed value.
+  */
+int CDPPacket::PowerAvailable::readPower(Power &power) const {
+    DataCursor cursor(tlv_value);
+
+    power.requestID = cursor.readBE16();
+    power.managementID = cursor.readBE16();
+    power.available = cursor.readBE32();
+
+    return cursor.ok();
+}
+
+/**
+  * Returns power in string representation.
+  * @return Power in format "%d mW (request %d, management %d)".
+  */
+const string CDPPacket::PowerAvailable::getValueStr() {
+    Power power;
+
+    if (!readPower(power)) {
+        return getMalformedStr();
+    }
+
+    return Data::toStr(power.available) + " mW (request " + Data::toStr(power.requestID)
+        + ", management " + Data::toStr(power.managementID) + ")";
+}
+
 /**
   * Checks packet whether is packet of this protocol.
   * @param packet Packet to be verified.
@@ -317,7 +539,7 @@ CDPPacket::Header CDPPacket::getHeader() const {
 
     // test that packet is valid
     if ((begin != -1) && (begin + HEADER_SIZE < data.length)) {
-        header = *(Header *)&data.data[begin];
+        memcpy(&header, &data.data[begin], sizeof(header)); // data may be unaligned
         header.checksum = ntohs(header.checksum);   // folding to this architecture
     }
 
@@ -329,90 +551,152 @@ CDPPacket::Header CDPPacket::getHeader() const {
   * @return Result of checksum check.
   */
 int CDPPacket::testCheckSum() const {
-    Header header;
     int begin = beginAt(), result;
 
     if ((begin != -1) && (begin + HEADER_SIZE < data.length)) {
-        // backup header
-        header = getHeader();
-        // setting checksum field to zero before checksum calculation
-        *(u_int16_t *)const_cast<u_int8_t *>(&data.data[begin + CHECKSUM_OFFSET]) = 0;
-        // calculating checksum and test
-        result = Data::checksum(data, begin) == header.checksum;
-        // restoring checksum
-        *(u_int16_t *)const_cast<u_int8_t *>(&data.data[begin + CHECKSUM_OFFSET]) = header.checksum;
-        return result;
+        // checksum field is counted as zero, data are not modified
+        result = Data::checksum(data, begin, begin + CHECKSUM_OFFSET) == getHeader().checksum;
+    } else {
+        result = 0;
     }
-    return 0;
+
+    if (!result && counters) {
+        counters->checksumFailures++;
+    }
+
+    return result;
+}
+
+/**
+  * Returns TLVs of packet. Whether decode cache of packet is set, TLVs
+  * decoded from identical PDU before are returned (counters are updated
+  * the same), otherwise packet is read by readPacket().
+  * @param tlvs Array where are TLV objects read whether packet has to be decoded.
+  * @return Decoded TLVs, valid until the next packet of sniffer.
+  */
+const TLVs &CDPPacket::decode(TLVs &tlvs) const {
+    const TLVs *cached;
+
+    if (decodeCache && (cached = decodeCache->decode(*this)) != NULL) {
+        return *cached;
+    }
+
+    readPacket(tlvs);
+    return tlvs;
 }
 
 /**
-  * Returns array of TLV objects generated from corresponding data of CDP packet.
-  * @return Array of TLV objects.
+  * Reads array of TLV objects generated from corresponding data of CDP packet.
+  * TLVs are allocated in arena of packet whether is set (valid until its reset).
+  * Whether projection of packet is set, only TLVs of selected types are read.
+  * @param tlvs Array where are TLV objects stored, its previous content is deleted.
   * @see TLV
   */
-TLVs CDPPacket::readPacket() const {
-    TLVs tlvs;
+void CDPPacket::readPacket(TLVs &tlvs) const {
     TLV *tlv = 0;
     Data tlv_data;
-    int type = 0, length = 0;
+    int type = 0, length = 0, malformed = 0;
     int position = beginAt() + HEADER_SIZE; // begin position
+    u_int32_t header;
+
+    tlvs.clear();               // old TLVs are deleted with their arena
+    tlvs.arena = arena;
 
     if (position > 0) {
         while (position + 3 < data.length) { // type and length is on 4 octets
-            type = ntohs(data.readUShort(position));
-            length = ntohs(data.readUShort(position + 2));
+            header = data.readBE32(position);   // type and length in one load
+            type = header >> 16;
+            length = header & 0xFFFF;
             tlv = 0;
 
             // value cannont exceed the end
             if ((position + length > data.length) || (length < TL_SIZE)) {
+                malformed = 1;
                 break;
             }
 
-            if (length) {   // there is some value
+            if (counters) counters->countTLV(type);
+
+            // types out of projection are skipped without decoding
+            if (length && (!projection || projection->isSelected(type))) {   // there is some value
                 // getting value data
                 tlv_data = Data(&data.data[position + TL_SIZE], length - TL_SIZE);
 
                 switch (type) { // switching types of data
                     case deviceID:
-                        tlv = new DeviceID(tlv_data);
+                        tlv = tlvs.create<DeviceID>(tlv_data);
                         break;
                     case addresses:
-                        tlv = new Addresses(tlv_data);
+                        tlv = tlvs.create<Addresses>(tlv_data);
                         break;
                     case portID:
-                        tlv = new PortID(tlv_data);
+                        tlv = tlvs.create<PortID>(tlv_data);
                         break;
                     case capabilities:
-                        tlv = new Capabilities(tlv_data);
+                        tlv = tlvs.create<Capabilities>(tlv_data);
                         break;
                     case softwareVersion:
-                        tlv = new SoftwareVersion(tlv_data);
+                        tlv = tlvs.create<SoftwareVersion>(tlv_data);
                         break;
                     case platform:
-                        tlv = new Platform(tlv_data);
+                        tlv = tlvs.create<Platform>(tlv_data);
                         break;
                     case duplex:
-                        tlv = new Duplex(tlv_data);
+                        tlv = tlvs.create<Duplex>(tlv_data);
                         break;
                     case mtu:
-                        tlv = new MTU(tlv_data);
+                        tlv = tlvs.create<MTU>(tlv_data);
                         break;
                     case systemName:
-                        tlv = new SystemName(tlv_data);
+                        tlv = tlvs.create<SystemName>(tlv_data);
+                        break;
+                    case vtpManagementDomain:
+                        tlv = tlvs.create<VTPManagementDomain>(tlv_data);
+                        break;
+                    case nativeVLAN:
+                        tlv = tlvs.create<NativeVLAN>(tlv_data);
+                        break;
+                    case voipVLANReply:
+                        tlv = tlvs.create<VoIPVLANReply>(tlv_data);
+                        break;
+                    case voipVLANQuery:
+                        tlv = tlvs.create<VoIPVLANQuery>(tlv_data);
+                        break;
+                    case powerConsumption:
+                        tlv = tlvs.create<PowerConsumption>(tlv_data);
+                        break;
+                    case trustBitmap:
+                        tlv = tlvs.create<TrustBitmap>(tlv_data);
+                        break;
+                    case untrustedCoS:
+                        tlv = tlvs.create<UntrustedCoS>(tlv_data);
+                        break;
+                    case managementAddresses:
+                        tlv = tlvs.create<ManagementAddresses>(tlv_data);
+                        break;
+                    case location:
+                        tlv = tlvs.create<Location>(tlv_data);
+                        break;
+                    case powerAvailable:
+                        tlv = tlvs.create<PowerAvailable>(tlv_data);
                         break;
                 }
             }
 
             if (tlv) {          // if new TLV object is created, push it into array
+                tlv->tlv_type = type;
                 tlvs.push_back(tlv);
             }
 
             position += length; // move position to the start of next TLV
         }
+    } else {
+        malformed = 1;
     }
 
-    return tlvs;    // return array of TLV objects
+    if (malformed && counters) {
+        counters->malformed++;
+    }
 }
 
 /**
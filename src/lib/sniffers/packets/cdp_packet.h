@@ -20,7 +20,6 @@
 
 #include <string>
 #include <vector>
-#include <map>
 
 #include "packet.h"
 #include "frames/ethernet_frame.h"
@@ -60,23 +59,29 @@ public:
         capabilities           = 0x04,
         softwareVersion        = 0x05,
         platform               = 0x06,
-        //these types are not implemented
         //http://www.cisco.com/en/US/products/hw/switches/ps4324/products_tech_note09186a0080094713.shtml
         //http://opensource.apple.com/source/tcpdump/tcpdump-27/tcpdump/print-cdp.c
+        //these types are not implemented
         //ipPrefix             = 0x07,
         //protocolHelloOption  = 0x08,
-        //vtpManagementDomain  = 0x09,
-        //nativeVLANID         = 0x0a,
+        vtpManagementDomain    = 0x09,
+        nativeVLAN             = 0x0a,
         duplex                 = 0x0b,
         //not implemented      = 0x0c,
         //not implemented      = 0x0d,
-        //not implemented      = 0x0e,
-        //not implemented      = 0x0f,
-        //not implemented      = 0x10,
+        voipVLANReply          = 0x0e,
+        voipVLANQuery          = 0x0f,
+        powerConsumption       = 0x10,
         mtu                    = 0x11,
-        //not implemented      = 0x12,
-        //not implemented      = 0x13,
-        systemName             = 0x14
+        trustBitmap            = 0x12,
+        untrustedCoS           = 0x13,
+        systemName             = 0x14,
+        //systemObjectID       = 0x15,
+        managementAddresses    = 0x16,
+        location               = 0x17,
+        //not implemented      = 0x18,
+        //not implemented      = 0x19,
+        powerAvailable         = 0x1a
         //other                = 0xXX
     };
 
@@ -139,7 +144,7 @@ public:
               */
             string toStr();
 
-            const static int MAX_PROTOCOL_LENGTH = 6;   /**< Maximal length of protocol */
+            const static int MAX_PROTOCOL_LENGTH = 8;   /**< Maximal length of protocol */
             const static int MAX_ADDRESS_LENGTH = 24;   /**< Maximal length of address */
 
             u_int8_t protocolType;                        /**< Protocol type */
@@ -162,14 +167,23 @@ public:
         const static string tlv_type_str;
 
         /**
-          * Map array with string representation of protocol types
+          * Returns name of protocol.
+          * @param protocol Protocol (for NLPID protocol type).
+          * @return Name of protocol or NULL whether is not defined.
+          */
+        static const char *protocolName(int protocol);
+
+        /**
+          * Array with names of protocol types indexed by type.
           */
-        const static map<int, string> protocol_types_str;
+        const static char *const protocol_types_str[IEEE802_2 + 1];
+
+        const static int IPV6_PROTOCOL_LENGTH = 8;  /**< Length of 802.2 protocol of IPv6 */
 
         /**
-          * Map array with strings of protocol names.
+          * 802.2 protocol (SNAP header with ethernet type) of IPv6.
           */
-        const static map<int, string> protocols_str;
+        const static u_int8_t IPV6_PROTOCOL[IPV6_PROTOCOL_LENGTH];
     };
 
     /**
@@ -218,7 +232,7 @@ public:
 
         const static int tlv_type = CDPPacket::capabilities;
         const static string tlv_type_str;
-        const static map<int, string> capabilities_str;
+        const static char *const capabilities_str[7];   /**< Names of capabilities bits */
     };
 
     /**
@@ -308,6 +322,257 @@ public:
         const static string tlv_type_str;
     };
 
+    /**
+      * Class of VTP management domain value.
+      * Value is string.
+      * @see TLV
+      */
+    class VTPManagementDomain :public TLV {
+
+    public:
+        VTPManagementDomain(const Data &data) :TLV(data) {}
+        virtual string getTypeName() { return tlv_type_str; }
+
+        const static int tlv_type  = CDPPacket::vtpManagementDomain;
+        const static string tlv_type_str;
+    };
+
+    /**
+      * Class of native VLAN value.
+      * Value is numeric.
+      * @see TLV
+      */
+    class NativeVLAN :public TLV {
+
+    public:
+        NativeVLAN(const Data &data) :TLV(data) {}
+        virtual string getTypeName() { return tlv_type_str; }
+
+        /**
+          * Returns VLAN as a string.
+          * @return Converted VLAN to string.
+          */
+        virtual const string getValueStr();
+
+        /**
+          * Returns native VLAN of port.
+          * @return VLAN ID or -1 on malformed value.
+          */
+        int getVLAN() const;
+
+        const static int tlv_type  = CDPPacket::nativeVLAN;
+        const static string tlv_type_str;
+    };
+
+    /**
+      * Class of VoIP VLAN reply value.
+      * Value is data octet followed by VLAN.
+      * @see TLV
+      */
+    class VoIPVLANReply :public TLV {
+
+    public:
+        VoIPVLANReply(const Data &data) :TLV(data) {}
+        virtual string getTypeName() { return tlv_type_str; }
+
+        /**
+          * Returns VLAN as a string.
+          * @return Converted VLAN to string, "none" whether VLAN is not present.
+          */
+        virtual const string getValueStr();
+
+        /**
+          * Returns VoIP VLAN.
+          * @return VLAN ID or -1 whether is not present.
+          */
+        int getVLAN() const;
+
+        const static int tlv_type  = CDPPacket::voipVLANReply;
+        const static string tlv_type_str;
+    };
+
+    /**
+      * Class of VoIP VLAN query value.
+      * Value has the same format as reply.
+      * @see VoIPVLANReply
+      */
+    class VoIPVLANQuery :public VoIPVLANReply {
+
+    public:
+        VoIPVLANQuery(const Data &data) :VoIPVLANReply(data) {}
+        virtual string getTypeName() { return tlv_type_str; }
+
+        const static int tlv_type  = CDPPacket::voipVLANQuery;
+        const static string tlv_type_str;
+    };
+
+    /**
+      * Class of power consumption value.
+      * Value is numeric in milliwatts.
+      * @see TLV
+      */
+    class PowerConsumption :public TLV {
+
+    public:
+        PowerConsumption(const Data &data) :TLV(data) {}
+        virtual string getTypeName() { return tlv_type_str; }
+
+        /**
+          * Returns power as a string.
+          * @return Converted power to string in format "%d mW".
+          */
+        virtual const string getValueStr();
+
+        /**
+          * Returns consumed power.
+          * @return Power [mW] or -1 on malformed value.
+          */
+        int getPower() const;
+
+        const static int tlv_type  = CDPPacket::powerConsumption;
+        const static string tlv_type_str;
+    };
+
+    /**
+      * Class of trust bitmap value.
+      * Value is bit array.
+      * @see TLV
+      */
+    class TrustBitmap :public TLV {
+
+    public:
+        /**
+          * Bits of trust bitmap.
+          */
+        enum bits {
+            extendedTrust       = 0x01
+        };
+
+        TrustBitmap(const Data &data) :TLV(data) {}
+        virtual string getTypeName() { return tlv_type_str; }
+
+        /**
+          * Returns trust in string representation.
+          * @return Trust "trusted" or "not trusted" and bitmap.
+          */
+        virtual const string getValueStr();
+
+        /**
+          * Returns trust bitmap.
+          * @return Bitmap or -1 on malformed value.
+          */
+        int getBitmap() const;
+
+        const static int tlv_type  = CDPPacket::trustBitmap;
+        const static string tlv_type_str;
+    };
+
+    /**
+      * Class of untrusted port CoS value.
+      * Value is numeric.
+      * @see TLV
+      */
+    class UntrustedCoS :public TLV {
+
+    public:
+        UntrustedCoS(const Data &data) :TLV(data) {}
+        virtual string getTypeName() { return tlv_type_str; }
+
+        /**
+          * Returns CoS as a string.
+          * @return Converted CoS to string.
+          */
+        virtual const string getValueStr();
+
+        /**
+          * Returns CoS applied to frames of untrusted port.
+          * @return CoS or -1 on malformed value.
+          */
+        int getCoS() const;
+
+        const static int tlv_type  = CDPPacket::untrustedCoS;
+        const static string tlv_type_str;
+    };
+
+    /**
+      * Class of management addresses value.
+      * Value has the same format as addresses.
+      * @see Addresses
+      */
+    class ManagementAddresses :public Addresses {
+
+    public:
+        ManagementAddresses(const Data &data) :Addresses(data) {}
+        virtual string getTypeName() { return tlv_type_str; }
+
+        const static int tlv_type  = CDPPacket::managementAddresses;
+        const static string tlv_type_str;
+    };
+
+    /**
+      * Class of location value.
+      * Value is format octet followed by string.
+      * @see TLV
+      */
+    class Location :public TLV {
+
+    public:
+        Location(const Data &data) :TLV(data) {}
+        virtual string getTypeName() { return tlv_type_str; }
+
+        /**
+          * Returns location string.
+          * @return Location without format octet.
+          */
+        virtual const string getValueStr();
+
+        /**
+          * Returns location without format octet.
+          * @return Location data, empty on malformed value.
+          */
+        Data getLocation() const;
+
+        const static int tlv_type  = CDPPacket::location;
+        const static string tlv_type_str;
+    };
+
+    /**
+      * Class of power available value.
+      * Value is request ID, management ID and available power.
+      * @see TLV
+      */
+    class PowerAvailable :public TLV {
+
+    public:
+        /**
+          * Struct of decoded value.
+          */
+        struct Power {
+            u_int16_t requestID;        /**< ID of power request */
+            u_int16_t managementID;     /**< ID of power management */
+            u_int32_t available;        /**< Available power [mW] */
+        };
+
+        PowerAvailable(const Data &data) :TLV(data) {}
+        virtual string getTypeName() { return tlv_type_str; }
+
+        /**
+          * Returns power in string representation.
+          * @return Power in format "%d mW (request %d, management %d)".
+          */
+        virtual const string getValueStr();
+
+        /**
+          * Reads available power.
+          * @param power Struct where is value stored.
+          * @return True on success, false on malformed value.
+          */
+        int readPower(Power &power) const;
+
+        const static int tlv_type  = CDPPacket::powerAvailable;
+        const static string tlv_type_str;
+    };
+
     /**
       * Constructor of CDP packet from data and protocols from which is made out.
       * @todo protocols has to be specified, more correct would be auto recognition by
@@ -350,11 +615,22 @@ public:
     int beginAt() const;
 
     /**
-      * Returns array of TLV objects generated from corresponding data of CDP packet.
-      * @return Array of TLV objects.
+      * Reads array of TLV objects generated from corresponding data of CDP packet.
+      * TLVs are allocated in arena of packet whether is set (valid until its reset).
+      * Whether projection of packet is set, only TLVs of selected types are read.
+      * @param tlvs Array where are TLV objects stored, its previous content is deleted.
       * @see TLV
       */
-    TLVs readPacket() const;
+    void readPacket(TLVs &tlvs) const;
+
+    /**
+      * Returns TLVs of packet. Whether decode cache of packet is set, TLVs
+      * decoded from identical PDU before are returned (counters are updated
+      * the same), otherwise packet is read by readPacket().
+      * @param tlvs Array where are TLV objects read whether packet has to be decoded.
+      * @return Decoded TLVs, valid until the next packet of sniffer.
+      */
+    const TLVs &decode(TLVs &tlvs) const;
 
     /**
       * Generates packet example protocol packet to be sent on interface.
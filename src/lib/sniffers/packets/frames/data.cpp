@@ -28,6 +28,146 @@
 
 using namespace std;
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CHECKSUM_SIMD
+#include <immintrin.h>
+#endif
+
+/**
+  * Function which sums 16 bit words of data in host order.
+  */
+typedef u_int64_t (*SumWordsFunction)(const u_int8_t *data, int size);
+
+/**
+  * Sums 16 bit words of data in host order, portable variant.
+  * @param data Pointer to data.
+  * @param size Size of data, has to be even.
+  * @return Sum of words, not folded.
+  */
+static u_int64_t sumWordsScalar(const u_int8_t *data, int size) {
+    u_int64_t sum = 0;
+    u_int32_t pair;
+    u_int16_t word;
+    int i = 0;
+
+    for (; i + 4 <= size; i += 4) {    // two words at once
+        memcpy(&pair, &data[i], sizeof(pair));
+        sum += (pair & 0xFFFF) + (pair >> 16);
+    }
+
+    if (i < size) {
+        memcpy(&word, &data[i], sizeof(word));
+        sum += word;
+    }
+
+    return sum;
+}
+
+#ifdef CHECKSUM_SIMD
+/**
+  * Sums 16 bit words of data in host order using SSE2. Words are widened
+  * into 32 bit lanes which are moved into 64 bit sum before they overflow.
+  * @param data Pointer to data.
+  * @param size Size of data, has to be even.
+  * @return Sum of words, not folded.
+  */
+__attribute__((target("sse2")))
+static u_int64_t sumWordsSSE2(const u_int8_t *data, int size) {
+    const __m128i zero = _mm_setzero_si128();
+    u_int32_t lanes[4];
+    u_int64_t sum = 0;
+    __m128i acc, block;
+    int i = 0, rounds;
+
+    while (size - i >= 16) {
+        acc = _mm_setzero_si128();
+        // every round adds at most 2 * 0xFFFF into each lane
+        for (rounds = 0; rounds < 0x7FFF && size - i >= 16; rounds++, i += 16) {
+            block = _mm_loadu_si128((const __m128i *)&data[i]);
+            acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(block, zero));
+            acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(block, zero));
+        }
+        _mm_storeu_si128((__m128i *)lanes, acc);
+        sum += u_int64_t(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+    }
+
+    return sum + sumWordsScalar(&data[i], size - i);
+}
+
+/**
+  * Sums 16 bit words of data in host order using AVX2.
+  * @param data Pointer to data.
+  * @param size Size of data, has to be even.
+  * @return Sum of words, not folded.
+  */
+__attribute__((target("avx2")))
+static u_int64_t sumWordsAVX2(const u_int8_t *data, int size) {
+    const __m256i zero = _mm256_setzero_si256();
+    u_int32_t lanes[8];
+    u_int64_t sum = 0;
+    __m256i acc, block;
+    int i = 0, rounds;
+
+    while (size - i >= 32) {
+        acc = _mm256_setzero_si256();
+        // every round adds at most 2 * 0xFFFF into each lane
+        for (rounds = 0; rounds < 0x7FFF && size - i >= 32; rounds++, i += 32) {
+            block = _mm256_loadu_si256((const __m256i *)&data[i]);
+            acc = _mm256_add_epi32(acc, _mm256_unpacklo_epi16(block, zero));
+            acc = _mm256_add_epi32(acc, _mm256_unpackhi_epi16(block, zero));
+        }
+        _mm256_storeu_si256((__m256i *)lanes, acc);
+        for (int lane = 0; lane < 8; lane++) {
+            sum += lanes[lane];
+        }
+    }
+
+    return sum + sumWordsSSE2(&data[i], size - i);
+}
+#endif
+
+/**
+  * Selects the fastest variant of summing supported by CPU.
+  * @return Summing function.
+  */
+static SumWordsFunction selectSumWords() {
+#ifdef CHECKSUM_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return sumWordsAVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return sumWordsSSE2;
+    }
+#endif
+    return sumWordsScalar;
+}
+
+/**
+  * Summing function selected once at startup.
+  */
+static const SumWordsFunction sumWords = selectSumWords();
+
+/**
+  * Lower case hexadecimal digits.
+  */
+const char Data::HEX_DIGITS[] = "0123456789abcdef";
+
+/**
+  * Decimal representation of numbers 00 - 99.
+  */
+static const char DIGIT_PAIRS[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
 /**
   * Appends new chars data. Appends only, does not allocates new space.
   * @param newData New data to be added to this object.
@@ -64,7 +204,9 @@ u_int16_t Data::readUShort(int position, int fromBit, int count) const {
   * @return Returns demanded unsgigned short value.
   */
 u_int16_t Data::readUShort(int position) const {
-    return *(u_int16_t *)&data[position];
+    u_int16_t value;
+    memcpy(&value, &data[position], sizeof(value));   // data may be unaligned
+    return value;
 }
 
 /**
@@ -116,40 +258,205 @@ int Data::strToInt(string str, int *ok) {
   * @return Converted array to hexadecimal string.
   */
 string Data::arrToHexStr(const u_int8_t *arr, int len) {
-    string result;
-    stringstream ss;
-    for (int i = 0; i < len; i++) {
-        ss << setfill ('0') << setw(2) << hex << int(*arr++);
-        result += ss.str() + ":";
-        ss.str("");
+    if (len <= 0) {
+        return string();
     }
-    result.erase(result.length() - 1);
+
+    string result(3 * len - 1, ':');    // two digits per byte and separators
+    formatHex(&result[0], arr, len);
     return result;
 }
 
 /**
-  * Counts IP checksum and returns number in host format.
+  * Converts IPv4 address to string in dotted decimal notation.
+  * @param address Address in network order (4 bytes).
+  * @return String representation of address.
+  */
+string Data::ipv4ToStr(const u_int8_t *address) {
+    char buffer[IPV4_STR_SIZE];
+    return string(buffer, formatIPv4(buffer, address));
+}
+
+/**
+  * Converts IPv6 address to string in RFC 5952 canonical form.
+  * @param address Address in network order (16 bytes).
+  * @return String representation of address.
+  */
+string Data::ipv6ToStr(const u_int8_t *address) {
+    char buffer[IPV6_STR_SIZE];
+    return string(buffer, formatIPv6(buffer, address));
+}
+
+/**
+  * Writes decimal representation of unsigned number into buffer.
+  * Digits are written from the end by pairs looked up in table.
+  * @param buffer Buffer of at least INT_STR_SIZE chars, not terminated.
+  * @param number Number to be written.
+  * @return Pointer behind the last written char.
+  */
+char *Data::formatUInt(char *buffer, u_int64_t number) {
+    char digits[INT_STR_SIZE];
+    char *end = digits + sizeof(digits), *pos = end;
+    const char *pair;
+
+    while (number >= 100) {
+        pair = &DIGIT_PAIRS[(number % 100) * 2];
+        number /= 100;
+        *--pos = pair[1];
+        *--pos = pair[0];
+    }
+
+    if (number >= 10) {
+        pair = &DIGIT_PAIRS[number * 2];
+        *--pos = pair[1];
+        *--pos = pair[0];
+    } else {
+        *--pos = char('0' + number);
+    }
+
+    memcpy(buffer, pos, end - pos);
+    return buffer + (end - pos);
+}
+
+/**
+  * Writes bytes in hexadecimal representation into buffer, e.g. MAC address.
+  * @param buffer Buffer of at least 3 * len chars, not terminated.
+  * @param arr Pointer to array.
+  * @param len Length of array.
+  * @param separator Char written between bytes, '\0' for none.
+  * @return Pointer behind the last written char.
+  */
+char *Data::formatHex(char *buffer, const u_int8_t *arr, int len, char separator) {
+    for (int i = 0; i < len; i++) {
+        if (i && separator) {
+            *buffer++ = separator;
+        }
+        *buffer++ = HEX_DIGITS[arr[i] >> 4];
+        *buffer++ = HEX_DIGITS[arr[i] & 0x0F];
+    }
+    return buffer;
+}
+
+/**
+  * Writes IPv4 address in dotted decimal notation into buffer.
+  * @param buffer Buffer of at least IPV4_STR_SIZE chars, not terminated.
+  * @param address Address in network order (4 bytes).
+  * @return Pointer behind the last written char.
+  */
+char *Data::formatIPv4(char *buffer, const u_int8_t *address) {
+    for (int i = 0; i < 4; i++) {
+        if (i) {
+            *buffer++ = '.';
+        }
+        // byte has at most three digits
+        if (address[i] >= 100) {
+            *buffer++ = char('0' + address[i] / 100);
+        }
+        if (address[i] >= 10) {
+            *buffer++ = DIGIT_PAIRS[(address[i] % 100) * 2];
+        }
+        *buffer++ = char('0' + address[i] % 10);
+    }
+    return buffer;
+}
+
+/**
+  * Writes IPv6 address in RFC 5952 canonical form into buffer. Groups are
+  * written in lower case without leading zeros, the longest run (the first
+  * one on tie) of at least two zero groups is replaced by "::".
+  * IPv4-mapped address is written with IPv4 in dotted decimal notation.
+  * @param buffer Buffer of at least IPV6_STR_SIZE chars, not terminated.
+  * @param address Address in network order (16 bytes).
+  * @return Pointer behind the last written char.
+  */
+char *Data::formatIPv6(char *buffer, const u_int8_t *address) {
+    static const u_int8_t MAPPED_PREFIX[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff};
+    unsigned groups[8], group;
+    int runStart = -1, runLength = 1, start = 0, length = 0;
+
+    if (!memcmp(address, MAPPED_PREFIX, sizeof(MAPPED_PREFIX))) {
+        memcpy(buffer, "::ffff:", 7);
+        return formatIPv4(buffer + 7, &address[12]);
+    }
+
+    // finding the longest run of zero groups, single group is not compressed
+    for (int i = 0; i < 8; i++) {
+        groups[i] = (unsigned(address[2 * i]) << 8) | address[2 * i + 1];
+        if (groups[i]) {
+            length = 0;
+            continue;
+        }
+        if (!length++) {
+            start = i;
+        }
+        if (length > runLength) {
+            runStart = start;
+            runLength = length;
+        }
+    }
+
+    for (int i = 0; i < 8; i++) {
+        if (i == runStart) {
+            *buffer++ = ':';
+            *buffer++ = ':';
+            i += runLength - 1;
+            continue;
+        }
+
+        if (i && i != runStart + runLength) {   // separator is already written behind run
+            *buffer++ = ':';
+        }
+
+        // group without leading zeros
+        group = groups[i];
+        if (group >= 0x1000) *buffer++ = HEX_DIGITS[group >> 12];
+        if (group >= 0x100) *buffer++ = HEX_DIGITS[(group >> 8) & 0x0F];
+        if (group >= 0x10) *buffer++ = HEX_DIGITS[(group >> 4) & 0x0F];
+        *buffer++ = HEX_DIGITS[group & 0x0F];
+    }
+
+    return buffer;
+}
+
+/**
+  * Counts IP checksum and returns number in host format. Data are not
+  * modified, field holding checksum can be skipped (counted as zero).
+  * Words are summed in host order, one's complement sum is independent
+  * of byte order, so result is just swapped after folding.
   * @param data Data above which will be calculated checksum.
   * @param from Postion where checksum should be calculated.
+  * @param skip Position of 16 bit field counted as zero, it has to be
+  *        in even distance from position from, -1 for none.
   * @return Returns IP checksum.
   */
-u_int16_t Data::checksum(const Data &data, int from) {
-    register u_int16_t size = data.length - from;
-    register const u_int16_t *packet =  (u_int16_t *)&data.data[from];
-    register u_int32_t sum = 0;
+u_int16_t Data::checksum(const Data &data, int from, int skip) {
+    const u_int8_t *begin = &data.data[from];
+    int size = data.length - from;
+    u_int8_t odd[2] = {0, 0};
+    u_int16_t word;
+    u_int64_t sum;
 
-   while (size > 1) {   // sums unsigned short data
-    sum += ntohs(*packet++);
-    size -= 2;
-   }
+    if (size <= 0) {
+        return 0xFFFF;
+    }
 
-   if (size > 0) {      // odd byte processing
-       sum += *(u_int8_t *)packet;
-   }
+    sum = sumWords(begin, size & ~1);
 
-   while (sum >> 16)  // folding to u_int8_t by adding until it is enough
-     sum = (sum & 0xFFFF) + (sum >> 16);
+    if (skip >= from && skip + 1 < data.length && !((skip - from) & 1)) {
+        // skipped field is summed too, subtracting it before folding is exact
+        memcpy(&word, &data.data[skip], sizeof(word));
+        sum -= word;
+    }
 
-    return ~sum;
-}
+    if (size & 1) {         // odd byte is added as low order byte
+        odd[1] = begin[size - 1];
+        memcpy(&word, odd, sizeof(word));
+        sum += word;
+    }
 
+    while (sum >> 16) {     // folding to u_int16_t by adding until it is enough
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+
+    return ~ntohs(u_int16_t(sum));
+}
@@ -20,10 +20,10 @@
 #ifndef DATA_H
 #define DATA_H
 
-#include <sstream>
-#include <iomanip>
 #include <string>
+#include <cstring>
 #include <pcap.h>
+#include <netinet/in.h>
 
 using namespace std;
 
@@ -61,6 +61,28 @@ public:
       */
     u_int16_t readUShort(int position) const;
 
+    /**
+      * Reads big endian (network order) unsigned short, data may be unaligned.
+      * @param position Position of start byte.
+      * @return Value in host order.
+      */
+    u_int16_t readBE16(int position) const {
+        u_int16_t value;
+        memcpy(&value, &data[position], sizeof(value));
+        return ntohs(value);
+    }
+
+    /**
+      * Reads big endian (network order) unsigned int, data may be unaligned.
+      * @param position Position of start byte.
+      * @return Value in host order.
+      */
+    u_int32_t readBE32(int position) const {
+        u_int32_t value;
+        memcpy(&value, &data[position], sizeof(value));
+        return ntohl(value);
+    }
+
     /**
       * Reads unsigned char value from specific byte and bit.
       * @param position Position of start byte from where reading should be accomplished.
@@ -78,12 +100,71 @@ public:
     u_int8_t readUChar(int position) const;
 
     /**
-      * Counts IP checksum and returns number in host format.
+      * Counts IP checksum and returns number in host format. Data are not
+      * modified, field holding checksum can be skipped (counted as zero).
       * @param data Data above which will be calculated checksum.
       * @param from Postion where checksum should be calculated.
+      * @param skip Position of 16 bit field counted as zero, it has to be
+      *        in even distance from position from, -1 for none.
       * @return Returns IP checksum.
       */
-    static u_int16_t checksum(const Data &data, int from);
+    static u_int16_t checksum(const Data &data, int from, int skip = -1);
+
+    static const int INT_STR_SIZE = 21;     /**< Maximal length of formatted integer (64 bits with sign) */
+    static const int MAC_STR_SIZE = 17;     /**< Length of formatted MAC address */
+    static const int IPV4_STR_SIZE = 15;    /**< Maximal length of formatted IPv4 address */
+    static const int IPV6_STR_SIZE = 39;    /**< Maximal length of formatted IPv6 address */
+    static const char HEX_DIGITS[];         /**< Lower case hexadecimal digits */
+
+    /**
+      * Writes decimal representation of unsigned number into buffer.
+      * @param buffer Buffer of at least INT_STR_SIZE chars, not terminated.
+      * @param number Number to be written.
+      * @return Pointer behind the last written char.
+      */
+    static char *formatUInt(char *buffer, u_int64_t number);
+
+    /**
+      * Writes decimal representation of integer number into buffer.
+      * @param buffer Buffer of at least INT_STR_SIZE chars, not terminated.
+      * @param number Number to be written.
+      * @return Pointer behind the last written char.
+      */
+    template< typename Type>
+    static char *formatInt(char *buffer, Type number) {
+        if (number < Type(0)) {
+            *buffer++ = '-';
+            return formatUInt(buffer, u_int64_t(0) - u_int64_t(number));
+        }
+        return formatUInt(buffer, u_int64_t(number));
+    }
+
+    /**
+      * Writes bytes in hexadecimal representation into buffer, e.g. MAC address.
+      * @param buffer Buffer of at least 3 * len chars, not terminated.
+      * @param arr Pointer to array.
+      * @param len Length of array.
+      * @param separator Char written between bytes, '\0' for none.
+      * @return Pointer behind the last written char.
+      */
+    static char *formatHex(char *buffer, const u_int8_t *arr, int len, char separator = ':');
+
+    /**
+      * Writes IPv4 address in dotted decimal notation into buffer.
+      * @param buffer Buffer of at least IPV4_STR_SIZE chars, not terminated.
+      * @param address Address in network order (4 bytes).
+      * @return Pointer behind the last written char.
+      */
+    static char *formatIPv4(char *buffer, const u_int8_t *address);
+
+    /**
+      * Writes IPv6 address in RFC 5952 canonical form into buffer
+      * (e.g. "2001:db8::1", IPv4-mapped as "::ffff:192.0.2.1").
+      * @param buffer Buffer of at least IPV6_STR_SIZE chars, not terminated.
+      * @param address Address in network order (16 bytes).
+      * @return Pointer behind the last written char.
+      */
+    static char *formatIPv6(char *buffer, const u_int8_t *address);
 
     /**
       * Converts various number type to its string representation in hexadecimal.
@@ -93,24 +174,40 @@ public:
       */
     template< typename Type>
     static string toHex(Type number) {
-        stringstream ss;
-        ss << setfill ('0') << setw(sizeof(Type) * 2) << hex << int(number);
-        return ss.str();
+        char buffer[sizeof(Type) * 2];
+
+        for (int i = sizeof(buffer) - 1; i >= 0; i--) {
+            buffer[i] = HEX_DIGITS[number & 0x0F];
+            number >>= 4;
+        }
+        return string(buffer, sizeof(buffer));
     }
 
     /**
-      * Converts various number type to its string representation.
-      * Value will be filled to its data type size.
+      * Converts various integer number type to its string representation.
       * @param number Number to be converted.
       * @return String representation of number.
       */
     template< typename Type>
-    static string toStr(Type variant) {
-        stringstream number;
-        number << variant;
-        return number.str();
+    static string toStr(Type number) {
+        char buffer[INT_STR_SIZE];
+        return string(buffer, formatInt(buffer, number));
     }
 
+    /**
+      * Converts IPv4 address to string in dotted decimal notation.
+      * @param address Address in network order (4 bytes).
+      * @return String representation of address.
+      */
+    static string ipv4ToStr(const u_int8_t *address);
+
+    /**
+      * Converts IPv6 address to string in RFC 5952 canonical form.
+      * @param address Address in network order (16 bytes).
+      * @return String representation of address.
+      */
+    static string ipv6ToStr(const u_int8_t *address);
+
     /**
       * Converts string number to int.
       * @param str String to be converted.
@@ -131,5 +228,95 @@ public:
     int length;             /**< Holds data length */
 };
 
+/**
+  * Cursor reading data sequentially with bounds checking. Read behind the
+  * end fails, returns zero (or NULL) and cursor stays failed for all next
+  * reads, so whole structure can be read first and validity checked once
+  * by ok(). Reads are inline, check costs one comparison.
+  */
+class DataCursor {
+public:
+    /**
+      * Constructor
+      * @param data Data to be read.
+      */
+    DataCursor(const Data &data):position(data.data), end(data.data + data.length), failed(0) {}
+
+    /**
+      * Tests whether all reads were in bounds.
+      * @return True whether no read failed.
+      */
+    int ok() const { return !failed; }
+
+    /**
+      * Returns count of bytes which has not been read.
+      * @return Remaining bytes, 0 when failed.
+      */
+    int remaining() const { return (failed) ? 0 : int(end - position); }
+
+    /**
+      * Reads array of bytes.
+      * @param count Count of bytes.
+      * @return Pointer to bytes in data, NULL when out of bounds.
+      */
+    const u_int8_t *read(int count) {
+        const u_int8_t *bytes = position;
+        if (!take(count)) return NULL;
+        return bytes;
+    }
+
+    /**
+      * Reads unsigned char.
+      * @return Value, 0 when out of bounds.
+      */
+    u_int8_t readU8() {
+        const u_int8_t *bytes = position;
+        return (take(1)) ? *bytes : 0;
+    }
+
+    /**
+      * Reads big endian (network order) unsigned short.
+      * @return Value in host order, 0 when out of bounds.
+      */
+    u_int16_t readBE16() {
+        const u_int8_t *bytes = position;
+        u_int16_t value;
+        if (!take(sizeof(value))) return 0;
+        memcpy(&value, bytes, sizeof(value));
+        return ntohs(value);
+    }
+
+    /**
+      * Reads big endian (network order) unsigned int.
+      * @return Value in host order, 0 when out of bounds.
+      */
+    u_int32_t readBE32() {
+        const u_int8_t *bytes = position;
+        u_int32_t value;
+        if (!take(sizeof(value))) return 0;
+        memcpy(&value, bytes, sizeof(value));
+        return ntohl(value);
+    }
+
+private:
+    /**
+      * Moves cursor whether count of bytes is available, otherwise fails.
+      * @param count Count of bytes.
+      * @return True on success.
+      */
+    int take(int count) {
+        if (failed || count < 0 || end - position < count) {
+            failed = 1;
+            return 0;
+        }
+        position += count;
+        return 1;
+    }
+
+    const u_int8_t *position;   /**< Current position */
+    const u_int8_t *end;        /**< End of data */
+    int failed;                 /**< Some read was out of bounds */
+};
+
 
 #endif // DATA_H
@@ -16,15 +16,23 @@
  */
 
 #include <netinet/in.h>
+#include <cstring>
 
 #include "ethernet_frame.h"
 
 /**
   * Returns ethernet header as a structure.
-  * @return Returns ethernet header as a structure.
+  * @return Returns ethernet header as a structure, zeroed when data are too short.
   */
 EthernetFrame::Ethernet EthernetFrame::getFrame() {
-    Ethernet header = *(Ethernet *)(data.data);
+    Ethernet header;
+
+    if (data.length < int(sizeof(Ethernet))) {     // truncated frame, zeroed header
+        memset(&header, 0, sizeof(header));
+        return header;
+    }
+
+    header = *(Ethernet *)(data.data);
     header.type = ntohs(header.type);
     return header;
 }
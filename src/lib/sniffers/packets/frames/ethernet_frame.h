@@ -46,7 +46,7 @@ public:
 
     /**
       * Returns ethernet header as a structure.
-      * @return Returns ethernet header as a structure.
+      * @return Returns ethernet header as a structure, zeroed when data are too short.
       */
     Ethernet getFrame();
 
@@ -140,7 +140,6 @@ MACAddress::MACAddress(const u_int8_t *arr) {
   * @return String representation of MAC address.
   */
 string MACAddress::toStr() {
-    return Data::toHex(mac[0]) + ":" + Data::toHex(mac[1]) + ":" +
-           Data::toHex(mac[2]) + ":" + Data::toHex(mac[3]) + ":" +
-           Data::toHex(mac[4]) + ":" + Data::toHex(mac[5]);
+    char buffer[Data::MAC_STR_SIZE];
+    return string(buffer, Data::formatHex(buffer, mac, MAC_ADDRESS_SIZE));
 }
@@ -16,7 +16,6 @@
  */
 
 #include <iostream>
-#include <map>
 #include <cstring>
 #include <pcap.h>
 #include <netinet/in.h>
@@ -25,6 +24,7 @@
 #include "protocols.h"
 #include "lldp_packet.h"
 #include "sysinfo.h"
+#include "../decode_cache.h"
 
 using namespace std;
 
@@ -48,26 +48,20 @@ const u_int8_t LLDPPacket::END_OF_LLDPDU[LLDPPacket::END_OF_LLDPDU_SIZE] = {0x00
 const string LLDPPacket::ChassisID::tlv_type_str = "Chassis ID";
 
 /**
-  * Mapping defined chassis ID subtypes to string representation.
+  * Names of chassis ID subtypes indexed by subtype.
   */
-pair<int, string> ChassisID_subtypes_mapping[] = {
-    std::make_pair(LLDPPacket::ChassisID::chassisComponent, "Interface alias"),
-    std::make_pair(LLDPPacket::ChassisID::interfaceAlias, "Interface alias"),
-    std::make_pair(LLDPPacket::ChassisID::portComponent, "Port component"),
-    std::make_pair(LLDPPacket::ChassisID::macAddress, "MAC address"),
-    std::make_pair(LLDPPacket::ChassisID::networkAddress, "Network address"),
-    std::make_pair(LLDPPacket::ChassisID::interfaceName, "Interface name"),
-    std::make_pair(LLDPPacket::ChassisID::agentCircuitID, "Agent circuit ID"),
-    std::make_pair(LLDPPacket::ChassisID::locallyAssigned, "Locally assigned")
+const char *const LLDPPacket::ChassisID::subtypes_str[] = {
+    /* 0 = */                   NULL,
+    /* chassisComponent = */    "Chassis component",
+    /* interfaceAlias = */      "Interface alias",
+    /* portComponent = */       "Port component",
+    /* macAddress = */          "MAC address",
+    /* networkAddress = */      "Network address",
+    /* interfaceName = */       "Interface name",
+    /* agentCircuitID = */      "Agent circuit ID",
+    /* locallyAssigned = */     "Locally assigned"
 };
 
-/**
-  * Initialization of chassis ID subtype mapping.
-  */
-const map<int, string> LLDPPacket::ChassisID::subtypes_str(
-    ChassisID_subtypes_mapping,
-    ChassisID_subtypes_mapping + sizeof ChassisID_subtypes_mapping / sizeof ChassisID_subtypes_mapping[0]);
-
 /**
   * Constructor which parses subtype and value.
   */
@@ -82,14 +76,8 @@ LLDPPacket::ChassisID::ChassisID(const Data &data) {
   * @return Subtype name of chassis ID
   */
 string LLDPPacket::ChassisID::getSubTypeName() {
-    string value = "unknown";
-    if (tlv_subType > -1) {
-        // Test whether has this subtype string represation
-        if (subtypes_str.find(tlv_subType) != subtypes_str.end()) {
-            value = subtypes_str.at(tlv_subType);
-        }
-    }
-    return value;
+    const char *name = tableName(subtypes_str, tlv_subType);
+    return (name) ? name : "unknown";
 }
 
 /**
@@ -97,9 +85,21 @@ string LLDPPacket::ChassisID::getSubTypeName() {
   * @return Value of specified subtype as a string
   */
 const string LLDPPacket::ChassisID::getValueStr() {
+    string result;
+
     switch (tlv_subType) {
-    case macAddress:    // MAC represation
-        return MACAddress(tlv_value.data).toStr();
+    case macAddress:
+        if (tlv_value.length != MACAddress::MAC_ADDRESS_SIZE) {
+            return getMalformedStr();
+        }
+        return MACAddress(tlv_value.data).toStr();  // MAC represation
+
+    case networkAddress:    // address family and address
+        if (tlv_value.length < 1) {
+            return getMalformedStr();
+        }
+        result = ManagementAddress::addressToStr(tlv_value.data[0], &tlv_value.data[1], tlv_value.length - 1);
+        return (result.empty()) ? "unknown (hex) - " + Data::arrToHexStr(tlv_value.data, tlv_value.length) : result;
 
     case interfaceAlias: case interfaceName: // string represation
         return TLV::getValueStr();
@@ -114,25 +114,19 @@ const string LLDPPacket::ChassisID::getValueStr() {
 const string LLDPPacket::PortID::tlv_type_str = "Port ID";
 
 /**
-  * Mapping defined port ID subtypes to string representation.
+  * Names of port ID subtypes indexed by subtype.
   */
-pair<int, string> PortID_subtypes_mapping[] = {
-    std::make_pair(LLDPPacket::PortID::interfaceAlias, "Interface alias"),
-    std::make_pair(LLDPPacket::PortID::portComponent,  "Port component"),
-    std::make_pair(LLDPPacket::PortID::macAddress,     "MAC address"),
-    std::make_pair(LLDPPacket::PortID::networkAddress, "Network address"),
-    std::make_pair(LLDPPacket::PortID::interfaceName,  "Interface name"),
-    std::make_pair(LLDPPacket::PortID::agentCircuitID, "Agent circuit ID"),
-    std::make_pair(LLDPPacket::PortID::locallyAssigned,"Locally assigned")
+const char *const LLDPPacket::PortID::subtypes_str[] = {
+    /* 0 = */                   NULL,
+    /* interfaceAlias = */      "Interface alias",
+    /* portComponent = */       "Port component",
+    /* macAddress = */          "MAC address",
+    /* networkAddress = */      "Network address",
+    /* interfaceName = */       "Interface name",
+    /* agentCircuitID = */      "Agent circuit ID",
+    /* locallyAssigned = */     "Locally assigned"
 };
 
-/**
-  * Initialization of port ID subtype mapping.
-  */
-const map<int, string> LLDPPacket::PortID::subtypes_str(
-    PortID_subtypes_mapping,
-    PortID_subtypes_mapping + sizeof PortID_subtypes_mapping / sizeof PortID_subtypes_mapping[0]);
-
 /**
   * Constructor which parses subtype and value.
   */
@@ -147,14 +141,8 @@ LLDPPacket::PortID::PortID(const Data &data) {
   * @return Subtype name of port ID
   */
 string LLDPPacket::PortID::getSubTypeName() {
-    string value = "unknown";
-    if (tlv_subType > -1) {
-        // Test whether has this subtype string represation
-        if (subtypes_str.find(tlv_subType) != subtypes_str.end()) {
-            value = subtypes_str.at(tlv_subType);
-        }
-    }
-    return value;
+    const char *name = tableName(subtypes_str, tlv_subType);
+    return (name) ? name : "unknown";
 }
 
 /**
@@ -162,9 +150,21 @@ string LLDPPacket::PortID::getSubTypeName() {
   * @return Value of specified subtype as a string
   */
 const string LLDPPacket::PortID::getValueStr() {
+    string result;
+
     switch (tlv_subType) {
-    case macAddress: // MAC representation
-        return MACAddress(tlv_value.data).toStr();
+    case macAddress:
+        if (tlv_value.length != MACAddress::MAC_ADDRESS_SIZE) {
+            return getMalformedStr();
+        }
+        return MACAddress(tlv_value.data).toStr();  // MAC representation
+
+    case networkAddress:    // address family and address
+        if (tlv_value.length < 1) {
+            return getMalformedStr();
+        }
+        result = ManagementAddress::addressToStr(tlv_value.data[0], &tlv_value.data[1], tlv_value.length - 1);
+        return (result.empty()) ? "unknown (hex) - " + Data::arrToHexStr(tlv_value.data, tlv_value.length) : result;
 
     case interfaceAlias: case interfaceName: // string representation
         return TLV::getValueStr();
@@ -183,7 +183,10 @@ const string LLDPPacket::TimeToLive::tlv_type_str = "Time To Live";
   * @return TTL number as a string
   */
 const string LLDPPacket::TimeToLive::getValueStr() {
-    return Data::toStr(ntohs(*(u_int16_t *) tlv_value.data))  + " s";
+    if (tlv_value.length < 2) {
+        return getMalformedStr();
+    }
+    return Data::toStr(tlv_value.readBE16(0))  + " s";
 }
 
 /**
@@ -207,56 +210,57 @@ const string LLDPPacket::SystemDescription::tlv_type_str = "System description";
 const string LLDPPacket::SystemCapabilities::tlv_type_str = "System capabilities";
 
 /**
-  * Mapping defined capabilities bits to string representation.
-  */
-pair<int, string> SystemCapabilities_capabilities_mapping[] = {
-    std::make_pair(LLDPPacket::SystemCapabilities::other,            "(other)"),
-    std::make_pair(LLDPPacket::SystemCapabilities::repeater,         "repeater"),
-    std::make_pair(LLDPPacket::SystemCapabilities::MACBridge,        "MAC bridge"),
-    std::make_pair(LLDPPacket::SystemCapabilities::WLANAccessPoint,  "WLAN access point"),
-    std::make_pair(LLDPPacket::SystemCapabilities::router,           "router"),
-    std::make_pair(LLDPPacket::SystemCapabilities::telephone,        "telephone"),
-    std::make_pair(LLDPPacket::SystemCapabilities::DOCSISCableDevice,"DOCSIS cable device"),
-    std::make_pair(LLDPPacket::SystemCapabilities::stationOnly,      "station only"),
-    std::make_pair(LLDPPacket::SystemCapabilities::CVLANofVLAN,      "C-VLAN Component of a VLAN Bridge"),
-    std::make_pair(LLDPPacket::SystemCapabilities::SVLANofVLAN,      "S-VLAN Component of a VLAN Bridge"),
-    std::make_pair(LLDPPacket::SystemCapabilities::TMPR,             "two-port MAC Relay (TPMR)"),
-    std::make_pair(LLDPPacket::SystemCapabilities::reserved_1,       "(unknown: 11. bit is set)"),
-    std::make_pair(LLDPPacket::SystemCapabilities::reserved_2,       "(unknown: 12. bit is set)"),
-    std::make_pair(LLDPPacket::SystemCapabilities::reserved_3,       "(unknown: 13. bit is set)"),
-    std::make_pair(LLDPPacket::SystemCapabilities::reserved_4,       "(unknown: 14. bit is set)"),
-    std::make_pair(LLDPPacket::SystemCapabilities::reserved_5,       "(unknown: 15. bit is set)")
+  * Names of capabilities indexed by bit (the least significant first).
+  */
+const char *const LLDPPacket::SystemCapabilities::capabilities_str[] = {
+    /* other = */               "(other)",
+    /* repeater = */            "repeater",
+    /* MACBridge = */           "MAC bridge",
+    /* WLANAccessPoint = */     "WLAN access point",
+    /* router = */              "router",
+    /* telephone = */           "telephone",
+    /* DOCSISCableDevice = */   "DOCSIS cable device",
+    /* stationOnly = */         "station only",
+    /* CVLANofVLAN = */         "C-VLAN Component of a VLAN Bridge",
+    /* SVLANofVLAN = */         "S-VLAN Component of a VLAN Bridge",
+    /* TMPR = */                "two-port MAC Relay (TPMR)",
+    /* reserved_1 = */          "(unknown: 11. bit is set)",
+    /* reserved_2 = */          "(unknown: 12. bit is set)",
+    /* reserved_3 = */          "(unknown: 13. bit is set)",
+    /* reserved_4 = */          "(unknown: 14. bit is set)",
+    /* reserved_5 = */          "(unknown: 15. bit is set)"
 };
 
-/**
-  * Initialization of capabilities mapping.
-  */
-const map<int, string> LLDPPacket::SystemCapabilities::capabilities_str(
-    SystemCapabilities_capabilities_mapping,
-    SystemCapabilities_capabilities_mapping + sizeof SystemCapabilities_capabilities_mapping / sizeof SystemCapabilities_capabilities_mapping[0]);
-
 /**
   * Returns specified capabilities and enabled capabilitis as a string delimited by commas.
   * @return Capabilities in string representation in format "<cap1>, <cap2>, ... (enabled: <cap1>, <cap2>, ...)"
   */
 const string LLDPPacket::SystemCapabilities::getValueStr() {
-    const int capabilities = ntohs(*(u_int16_t *)tlv_value.data);
-    const int enabled = ntohs(*(u_int16_t *)&tlv_value.data[2]);
+    DataCursor cursor(tlv_value);
+    const int capabilities = cursor.readBE16();
+    const int enabled = cursor.readBE16();
 
     u_int16_t mask = 0x0001; // test mask
     string result;
 
+    if (!cursor.ok()) {
+        return getMalformedStr();
+    }
+
     // shifting mask and getting capabilities
     for (int i = 0; i < 16; i++) {
         if (capabilities & mask) {
             // defined is whole range, there no way,
-            // that mask would not be defined in mapping array
-            result += capabilities_str.at(mask) + ", ";
+            // that bit would not be defined in names array
+            result += capabilities_str[i];
+            result += ", ";
         }
         mask <<= 1;
     }
 
-    result.erase(result.length() - 2); // deleting last comma
+    if (result.length()) {
+        result.erase(result.length() - 2); // deleting last comma
+    }
 
     // now getting enabled capabilities
     if (enabled > 0) {
@@ -265,7 +269,8 @@ const string LLDPPacket::SystemCapabilities::getValueStr() {
         // shifting mask and getting enabled capabilities
         for (int i = 0; i < 16; i++) {
             if (enabled & mask) {
-                result += capabilities_str.at(mask) + ", ";
+                result += capabilities_str[i];
+                result += ", ";
             }
             mask <<= 1;
         }
@@ -282,56 +287,43 @@ const string LLDPPacket::SystemCapabilities::getValueStr() {
 const string LLDPPacket::ManagementAddress::tlv_type_str = "Management address";
 
 /**
-  * Mapping defined chassis ID subtypes to string representation.
-  */
-pair<int, string> ManagementAddress_subtypes_mapping[] = {
-    std::make_pair(LLDPPacket::ManagementAddress::IPv4, "IPv4"),
-    std::make_pair(LLDPPacket::ManagementAddress::IPv6, "IPv6"),
-    std::make_pair(LLDPPacket::ManagementAddress::NSAP, "NSAP"),
-    std::make_pair(LLDPPacket::ManagementAddress::HDLC, "HDLC"),
-    std::make_pair(LLDPPacket::ManagementAddress::BBN_1822, "BBN 1822"),
-    std::make_pair(LLDPPacket::ManagementAddress::all802, "all 802"),
-    std::make_pair(LLDPPacket::ManagementAddress::E_163, "E.163"),
-    std::make_pair(LLDPPacket::ManagementAddress::E_164, "E.164"),
-    std::make_pair(LLDPPacket::ManagementAddress::F_69, "F.69"),
-    std::make_pair(LLDPPacket::ManagementAddress::X_121, "X.121"),
-    std::make_pair(LLDPPacket::ManagementAddress::IPX, "IPX"),
-    std::make_pair(LLDPPacket::ManagementAddress::appleTalk, "Appletalk"),
-    std::make_pair(LLDPPacket::ManagementAddress::decnetIV, "Decnet IV"),
-    std::make_pair(LLDPPacket::ManagementAddress::banyanVines, "Banyan Vines"),
-    std::make_pair(LLDPPacket::ManagementAddress::E_164_NSAP, "E.164 with NSAP format subaddress"),
-    std::make_pair(LLDPPacket::ManagementAddress::DNS, "DNS")
+  * Names of management address subtypes indexed by subtype.
+  */
+const char *const LLDPPacket::ManagementAddress::subtypes_str[] = {
+    /* 0 = */                   NULL,
+    /* IPv4 = */                "IPv4",
+    /* IPv6 = */                "IPv6",
+    /* NSAP = */                "NSAP",
+    /* HDLC = */                "HDLC",
+    /* BBN_1822 = */            "BBN 1822",
+    /* all802 = */              "all 802",
+    /* E_163 = */               "E.163",
+    /* E_164 = */               "E.164",
+    /* F_69 = */                "F.69",
+    /* X_121 = */               "X.121",
+    /* IPX = */                 "IPX",
+    /* appleTalk = */           "Appletalk",
+    /* decnetIV = */            "Decnet IV",
+    /* banyanVines = */         "Banyan Vines",
+    /* E_164_NSAP = */          "E.164 with NSAP format subaddress",
+    /* DNS = */                 "DNS"
 };
 
 /**
-  * Initialization of chassis ID subtype mapping.
+  * Names of interface numbering subtypes indexed by subtype.
   */
-const map<int, string> LLDPPacket::ManagementAddress::subtypes_str(
-    ManagementAddress_subtypes_mapping,
-    ManagementAddress_subtypes_mapping + sizeof ManagementAddress_subtypes_mapping / sizeof ManagementAddress_subtypes_mapping[0]);
-
-/**
-  * Mapping defined chassis ID subtypes to string representation.
-  */
-pair<int, string> ManagementAddress_interfaceNumeringSubtype_str_mapping[] = {
-    std::make_pair(LLDPPacket::ManagementAddress::unknown, "unknown"),
-    std::make_pair(LLDPPacket::ManagementAddress::ifIndex, "ifIndex"),
-    std::make_pair(LLDPPacket::ManagementAddress::systemPortNumer, "system port number")
+const char *const LLDPPacket::ManagementAddress::interfaceNumeringSubtype_str[] = {
+    /* 0 = */                   NULL,
+    /* unknown = */             "unknown",
+    /* ifIndex = */             "ifIndex",
+    /* systemPortNumer = */     "system port number"
 };
 
-/**
-  * Initialization of chassis ID subtype mapping.
-  */
-const map<int, string> LLDPPacket::ManagementAddress::interfaceNumeringSubtype_str (
-    ManagementAddress_interfaceNumeringSubtype_str_mapping,
-    ManagementAddress_interfaceNumeringSubtype_str_mapping + sizeof ManagementAddress_interfaceNumeringSubtype_str_mapping / sizeof ManagementAddress_interfaceNumeringSubtype_str_mapping[0]);
-
-
 /**
   * Constructor which parses subtype and value.
   */
 LLDPPacket::ManagementAddress::ManagementAddress(const Data &data) {
-    int subtype = data.readUChar(1);
+    int subtype = (data.length > 1) ? data.readUChar(1) : NO_SUBTYPE;
     setValue(data, subtype);   // saving everything
 }
 
@@ -340,14 +332,27 @@ LLDPPacket::ManagementAddress::ManagementAddress(const Data &data) {
   * @return Subtype name of management address
   */
 string LLDPPacket::ManagementAddress::getSubTypeName() {
-    string value = "unknown";
-    if (tlv_subType > -1) {
-        // Test whether has this subtype string represation
-        if (subtypes_str.find(tlv_subType) != subtypes_str.end()) {
-            value = subtypes_str.at(tlv_subType);
-        }
+    const char *name = tableName(subtypes_str, tlv_subType);
+    return (name) ? name : "unknown";
+}
+
+/**
+  * Converts address of family to string.
+  * @param family Address family (subtype), IPv4, IPv6 and all802 are supported.
+  * @param address Address in network order.
+  * @param length Length of address.
+  * @return String representation of address, empty whether family
+  *         is not supported or length does not match.
+  */
+string LLDPPacket::ManagementAddress::addressToStr(int family, const u_int8_t *address, int length) {
+    if (family == IPv4 && length == 4) {                                    // IPv4 represation
+        return Data::ipv4ToStr(address);
+    } else if (family == IPv6 && length == 16) {                            // IPv6 represation
+        return Data::ipv6ToStr(address);
+    } else if (family == all802 && length == MACAddress::MAC_ADDRESS_SIZE) {    // MAC represation
+        return MACAddress(address).toStr();
     }
-    return value;
+    return string();
 }
 
 /**
@@ -355,41 +360,309 @@ string LLDPPacket::ManagementAddress::getSubTypeName() {
   * @return Value of specified subtype as a string
   */
 const string LLDPPacket::ManagementAddress::getValueStr() {
-    const u_int8_t *value = tlv_value.data;
-    u_int8_t mngAddrLen = *value++;
-    u_int8_t subType = *value++;
-    const u_int8_t *addr = value;
+    DataCursor cursor(tlv_value);
+    int addrLength = cursor.readU8() - 1;   // length includes subtype
+    u_int8_t subType = cursor.readU8();
+    const u_int8_t *addr = cursor.read(addrLength);
+    u_int8_t interfaceSubtype = cursor.readU8();
+    u_int32_t interfaceNumber = cursor.readBE32();
+    const char *name;
     string result;
 
-    switch (subType) {
-    case IPv4:    // IPv4 represation
-        result = Data::toStr(int(addr[0])) + "." + Data::toStr(int(addr[1])) + "."
-            + Data::toStr(int(addr[2])) + "." + Data::toStr(int(addr[3]));
-        break;
-    case all802: // MAC represation
-        result = MACAddress(addr).toStr();
-        break;
-    default: // unsupported subtype
+    if (!cursor.ok()) {     // lengths exceed the value
+        return getMalformedStr();
+    }
+
+    result = addressToStr(subType, addr, addrLength);
+    if (result.empty()) {   // unsupported subtype
         result = "unknown (hex) - " + Data::arrToHexStr(tlv_value.data, tlv_value.length);
-        break;
     }
 
-    value += mngAddrLen - 1;
     result += " (";
 
-        // Test whether has this interface numbering subtype string represation
-    if (interfaceNumeringSubtype_str.find(*value) != interfaceNumeringSubtype_str.end()) {
-        result += interfaceNumeringSubtype_str.at(*value);
-    } else {
-        result += "unknown";
+    // Test whether has this interface numbering subtype string represation
+    name = tableName(interfaceNumeringSubtype_str, interfaceSubtype);
+    result += (name) ? name : "unknown";
+
+    result += ": " + Data::toStr(interfaceNumber) + ")";
+
+    return result;
+
+}
+
+/**
+  * Name of organizationally specific type.
+  */
+const string LLDPPacket::OrganizationallySpecific::tlv_type_str = "Organizationally specific";
+
+/**
+  * Definitions of IEEE 802.1 values indexed by subtype.
+  */
+static const LLDPPacket::OrganizationallySpecific::Definition IEEE_802_1_DEFINITIONS[] = {
+    /* 0 = */ {-1, 0, NULL},
+    /* 1 = */ {LLDPPacket::OrganizationallySpecific::VLAN_ID,           2, "Port VLAN ID"},
+    /* 2 = */ {LLDPPacket::OrganizationallySpecific::PROTOCOL_VLAN_ID,  3, "Port and protocol VLAN ID"},
+    /* 3 = */ {LLDPPacket::OrganizationallySpecific::VLAN_NAME,         3, "VLAN name"},
+    /* 4 = */ {LLDPPacket::OrganizationallySpecific::PROTOCOL_IDENTITY, 1, "Protocol identity"},
+    /* 5 = */ {-1, 0, NULL},
+    /* 6 = */ {-1, 0, NULL},
+    /* 7 = */ {LLDPPacket::OrganizationallySpecific::LINK_AGGREGATION,  5, "Link aggregation"}
+};
+
+/**
+  * Definitions of IEEE 802.3 values indexed by subtype.
+  */
+static const LLDPPacket::OrganizationallySpecific::Definition IEEE_802_3_DEFINITIONS[] = {
+    /* 0 = */ {-1, 0, NULL},
+    /* 1 = */ {LLDPPacket::OrganizationallySpecific::MAC_PHY_STATUS,    5, "MAC/PHY configuration/status"},
+    /* 2 = */ {LLDPPacket::OrganizationallySpecific::POWER_VIA_MDI,     3, "Power via MDI"},
+    /* 3 = */ {LLDPPacket::OrganizationallySpecific::LINK_AGGREGATION,  5, "Link aggregation"},
+    /* 4 = */ {LLDPPacket::OrganizationallySpecific::MAX_FRAME_SIZE,    2, "Maximum frame size"}
+};
+
+/**
+  * Definitions of LLDP-MED values indexed by subtype.
+  */
+static const LLDPPacket::OrganizationallySpecific::Definition TIA_MED_DEFINITIONS[] = {
+    /* 0 = */  {-1, 0, NULL},
+    /* 1 = */  {LLDPPacket::OrganizationallySpecific::MED_CAPABILITIES, 3, "MED capabilities"},
+    /* 2 = */  {LLDPPacket::OrganizationallySpecific::NETWORK_POLICY,   4, "Network policy"},
+    /* 3 = */  {LLDPPacket::OrganizationallySpecific::LOCATION,         1, "Location identification"},
+    /* 4 = */  {LLDPPacket::OrganizationallySpecific::EXTENDED_POWER,   3, "Extended power via MDI"},
+    /* 5 = */  {LLDPPacket::OrganizationallySpecific::STRING,           0, "Hardware revision"},
+    /* 6 = */  {LLDPPacket::OrganizationallySpecific::STRING,           0, "Firmware revision"},
+    /* 7 = */  {LLDPPacket::OrganizationallySpecific::STRING,           0, "Software revision"},
+    /* 8 = */  {LLDPPacket::OrganizationallySpecific::STRING,           0, "Serial number"},
+    /* 9 = */  {LLDPPacket::OrganizationallySpecific::STRING,           0, "Manufacturer name"},
+    /* 10 = */ {LLDPPacket::OrganizationallySpecific::STRING,           0, "Model name"},
+    /* 11 = */ {LLDPPacket::OrganizationallySpecific::STRING,           0, "Asset ID"}
+};
+
+/**
+  * Names of LLDP-MED network policy application types indexed by type.
+  */
+static const char *const NETWORK_POLICY_APPLICATIONS[] = {
+    NULL, "voice", "voice signaling", "guest voice", "guest voice signaling",
+    "softphone voice", "video conferencing", "streaming video", "video signaling"
+};
+
+/**
+  * Names of LLDP-MED device types indexed by type.
+  */
+static const char *const MED_DEVICE_TYPES[] = {
+    "not defined", "endpoint class I", "endpoint class II", "endpoint class III", "network connectivity"
+};
+
+/**
+  * Names of LLDP-MED power priorities indexed by priority.
+  */
+static const char *const POWER_PRIORITIES[] = {
+    "unknown", "critical", "high", "low"
+};
+
+/**
+  * Returns definition from table indexed by subtype.
+  * @param definitions Table of definitions.
+  * @param subtype Subtype of value.
+  * @return Definition or NULL whether is not defined.
+  */
+template<size_t N>
+static const LLDPPacket::OrganizationallySpecific::Definition *tableDefinition(
+        const LLDPPacket::OrganizationallySpecific::Definition (&definitions)[N], int subtype) {
+    return (subtype >= 0 && size_t(subtype) < N && definitions[subtype].format != -1) ? &definitions[subtype] : NULL;
+}
+
+/**
+  * Returns definition of OUI and subtype.
+  * @param oui OUI of organization.
+  * @param subtype Subtype of value.
+  * @return Definition or NULL whether is not supported.
+  */
+const LLDPPacket::OrganizationallySpecific::Definition *LLDPPacket::OrganizationallySpecific::findDefinition(int oui, int subtype) {
+    switch (oui) {
+    case IEEE_802_1:
+        return tableDefinition(IEEE_802_1_DEFINITIONS, subtype);
+    case IEEE_802_3:
+        return tableDefinition(IEEE_802_3_DEFINITIONS, subtype);
+    case TIA_MED:
+        return tableDefinition(TIA_MED_DEFINITIONS, subtype);
+    default:
+        return NULL;
     }
+}
 
-    value++;
+/**
+  * Constructor which parses OUI, subtype and value.
+  */
+LLDPPacket::OrganizationallySpecific::OrganizationallySpecific(const Data &data) :oui(-1), definition(NULL) {
+    if (data.length < HEADER_SIZE) {    // malformed, whole data are kept
+        setValue(data);
+        return;
+    }
 
-    result += ": " + Data::toStr(ntohl(*(u_int32_t *)value)) + ")";
+    oui = (data.readBE32(0) >> 8);
+    setValue(Data(&data.data[HEADER_SIZE], data.length - HEADER_SIZE), data.readUChar(HEADER_SIZE - 1));
+    definition = findDefinition(oui, tlv_subType);
+}
 
-    return result;
+/**
+  * Returns name of OUI and subtype.
+  * @return Subtype name of value.
+  */
+string LLDPPacket::OrganizationallySpecific::getSubTypeName() {
+    if (definition) {
+        return definition->name;
+    }
+
+    return (oui == -1) ? "unknown" : "OUI " + Data::arrToHexStr(tlv_value.data - HEADER_SIZE, HEADER_SIZE - 1)
+        + ", subtype " + Data::toStr(tlv_subType);
+}
+
+/**
+  * Reads fields of value by its definition.
+  * @param fields Fields where are values stored.
+  * @return True on success, false whether value is unsupported or malformed.
+  */
+int LLDPPacket::OrganizationallySpecific::readFields(Fields &fields) const {
+    DataCursor cursor(tlv_value);
+    u_int32_t policy;
+    int length;
+
+    fields = Fields();
+
+    if (!definition || tlv_value.length < definition->minLength) {
+        return 0;
+    }
+
+    switch (definition->format) {
+    case VLAN_ID:
+        fields.vlan = cursor.readBE16();
+        break;
+    case PROTOCOL_VLAN_ID:
+        fields.flags = cursor.readU8();
+        fields.vlan = cursor.readBE16();
+        break;
+    case VLAN_NAME:
+        fields.vlan = cursor.readBE16();
+        length = cursor.readU8();
+        fields.text = Data(cursor.read(length), length);
+        break;
+    case PROTOCOL_IDENTITY:
+        length = cursor.readU8();
+        fields.text = Data(cursor.read(length), length);
+        break;
+    case LINK_AGGREGATION:
+        fields.flags = cursor.readU8();
+        fields.port = cursor.readBE32();
+        break;
+    case MAC_PHY_STATUS:
+        fields.flags = cursor.readU8();
+        fields.advertised = cursor.readBE16();
+        fields.number = cursor.readBE16();
+        break;
+    case POWER_VIA_MDI:
+        fields.flags = cursor.readU8();
+        fields.priority = cursor.readU8();      // power pair
+        fields.kind = cursor.readU8();          // power class
+        break;
+    case MAX_FRAME_SIZE:
+        fields.number = cursor.readBE16();
+        break;
+    case MED_CAPABILITIES:
+        fields.number = cursor.readBE16();
+        fields.kind = cursor.readU8();
+        break;
+    case NETWORK_POLICY:
+        fields.kind = cursor.readU8();
+        policy = (u_int32_t(cursor.readU8()) << 16) | cursor.readBE16();
+        fields.flags = policy >> 21;            // unknown policy, tagged, reserved bits
+        fields.vlan = (policy >> 9) & 0x0FFF;
+        fields.priority = (policy >> 6) & 0x07;
+        fields.dscp = policy & 0x3F;
+        break;
+    case LOCATION:
+        fields.kind = cursor.readU8();
+        fields.text = Data(cursor.read(cursor.remaining()), tlv_value.length - 1);
+        break;
+    case EXTENDED_POWER:
+        fields.flags = cursor.readU8();         // power type and source
+        fields.kind = fields.flags >> 6;
+        fields.priority = fields.flags & 0x0F;
+        fields.number = cursor.readBE16();
+        break;
+    case STRING:
+        fields.text = tlv_value;
+        break;
+    }
 
+    return cursor.ok();
+}
+
+/**
+  * Returns converted value in string representation.
+  * @return Value of specified OUI and subtype as a string
+  */
+const string LLDPPacket::OrganizationallySpecific::getValueStr() {
+    Fields fields;
+    const char *name;
+    string result;
+
+    if (!definition) {                  // unsupported OUI or subtype
+        return (oui == -1) ? getMalformedStr() : "unknown (hex) - " + Data::arrToHexStr(tlv_value.data, tlv_value.length);
+    }
+
+    if (!readFields(fields)) {
+        return getMalformedStr();
+    }
+
+    switch (definition->format) {
+    case VLAN_ID:
+        return "VLAN " + Data::toStr(fields.vlan);
+    case PROTOCOL_VLAN_ID:
+        return "VLAN " + Data::toStr(fields.vlan) + ((fields.flags & 0x02) ? " (supported" : " (not supported")
+            + ((fields.flags & 0x04) ? ", enabled)" : ", disabled)");
+    case VLAN_NAME:
+        return "VLAN " + Data::toStr(fields.vlan) + ": " + string((const char *)fields.text.data, fields.text.length);
+    case PROTOCOL_IDENTITY: case LOCATION:
+        return Data::arrToHexStr(fields.text.data, fields.text.length);
+    case LINK_AGGREGATION:
+        result = (fields.flags & 0x01) ? "capable" : "not capable";
+        if (fields.flags & 0x02) {
+            result += ", aggregated, port " + Data::toStr(fields.port);
+        }
+        return result;
+    case MAC_PHY_STATUS:
+        result = "autonegotiation ";
+        result += (fields.flags & 0x01) ? "supported" : "not supported";
+        result += (fields.flags & 0x02) ? ", enabled" : ", disabled";
+        return result + ", advertised 0x" + Data::toHex(fields.advertised) + ", MAU type " + Data::toStr(fields.number);
+    case POWER_VIA_MDI:
+        result = (fields.flags & 0x01) ? "PSE" : "PD";
+        result += (fields.flags & 0x02) ? ", supported" : ", not supported";
+        result += (fields.flags & 0x04) ? ", enabled" : ", disabled";
+        return result + ", power pair " + Data::toStr(fields.priority) + ", class " + Data::toStr(fields.kind ? fields.kind - 1 : 0);
+    case MAX_FRAME_SIZE:
+        return Data::toStr(fields.number);
+    case MED_CAPABILITIES:
+        name = tableName(MED_DEVICE_TYPES, fields.kind);
+        return "0x" + Data::toHex(fields.number) + ", device type: " + ((name) ? name : "reserved");
+    case NETWORK_POLICY:
+        name = tableName(NETWORK_POLICY_APPLICATIONS, fields.kind);
+        result = (name) ? name : "application " + Data::toStr(fields.kind);
+        if (fields.flags & 0x04) {      // policy is unknown
+            return result + ", unknown policy";
+        }
+        return result + ", VLAN " + Data::toStr(fields.vlan) + ((fields.flags & 0x02) ? " (tagged)" : " (untagged)")
+            + ", priority " + Data::toStr(fields.priority) + ", DSCP " + Data::toStr(fields.dscp);
+    case EXTENDED_POWER:
+        name = tableName(POWER_PRIORITIES, fields.priority);
+        result = (fields.kind & 0x01) ? "PD" : "PSE";
+        result += ", priority ";
+        result += (name) ? name : "reserved";
+        return result + ", " + Data::toStr(fields.number / 10) + "." + Data::toStr(fields.number % 10) + " W";
+    default:    // STRING
+        return TLV::getValueStr();
+    }
 }
 
 /**
@@ -446,65 +719,97 @@ int LLDPPacket::beginAt() const {
 }
 
 /**
-  * Returns array of TLV objects generated from corresponding data of LLDP packet.
-  * @return Array of TLV objects.
+  * Returns TLVs of packet. Whether decode cache of packet is set, TLVs
+  * decoded from identical PDU before are returned (counters are updated
+  * the same), otherwise packet is read by readPacket().
+  * @param tlvs Array where are TLV objects read whether packet has to be decoded.
+  * @return Decoded TLVs, valid until the next packet of sniffer.
+  */
+const TLVs &LLDPPacket::decode(TLVs &tlvs) const {
+    const TLVs *cached;
+
+    if (decodeCache && (cached = decodeCache->decode(*this)) != NULL) {
+        return *cached;
+    }
+
+    readPacket(tlvs);
+    return tlvs;
+}
+
+/**
+  * Reads array of TLV objects generated from corresponding data of LLDP packet.
+  * TLVs are allocated in arena of packet whether is set (valid until its reset).
+  * Whether projection of packet is set, only TLVs of selected types are read.
+  * @param tlvs Array where are TLV objects stored, its previous content is deleted.
   * @see TLV
   */
-TLVs LLDPPacket::readPacket() const {
-    TLVs tlvs;
+void LLDPPacket::readPacket(TLVs &tlvs) const {
     TLV *tlv = 0;
     Data tlv_data;
-    int type = 0, length = 0;
+    int type = 0, length = 0, malformed = 1;
     int position = beginAt();   // getting start position of TLV structures
+    u_int16_t header;
+
+    tlvs.clear();               // old TLVs are deleted with their arena
+    tlvs.arena = arena;
 
     if (position > 0) {
         while (position + 1 < data.length) { // type-length items on 2 octets
-            type = data.readUChar(position, 0, 7);      // type is on 7 bits
-            length = data.readUShort(position, 7, 9);   // length is on 8 bits
+            header = data.readBE16(position);
+            type = header >> TYPE_SHIFT;                // type is on 7 bits
+            length = header & LENGTH_MASK;              // length is on 9 bits
             tlv = 0;
 
             // test whether length of TLV does not exceed the end of packet
-            if (position + TL_SIZE + length >= data.length) {
+            if (position + TL_SIZE + length > data.length) {
                 break;
             }
 
             // test whether is end of packet
             if (type == endOfLLPDU) {
+                malformed = 0;
                 break;
             }
 
-            if (length) {   // there are some data
+            if (counters) counters->countTLV(type);
+
+            // types out of projection are skipped without decoding
+            if (length && (!projection || projection->isSelected(type))) {   // there are some data
                 // getting data
                 tlv_data = Data(&data.data[position + TL_SIZE], length);
                 switch (type) { // switching types of data
                     case chassisID:
-                        tlv = new ChassisID(tlv_data);
+                        tlv = tlvs.create<ChassisID>(tlv_data);
                         break;
                     case portID:
-                        tlv = new PortID(tlv_data);
+                        tlv = tlvs.create<PortID>(tlv_data);
                         break;
                     case timeToLive:
-                        tlv = new TimeToLive(tlv_data);
+                        tlv = tlvs.create<TimeToLive>(tlv_data);
                         break;
                     case portDescription:
-                        tlv = new PortDescription(tlv_data);
+                        tlv = tlvs.create<PortDescription>(tlv_data);
                         break;
                     case systemName:
-                        tlv = new SystemName(tlv_data);
+                        tlv = tlvs.create<SystemName>(tlv_data);
                         break;
                     case systemDescription:
-                        tlv = new SystemDescription(tlv_data);
+                        tlv = tlvs.create<SystemDescription>(tlv_data);
                         break;
                     case systemCapabilities:
-                        tlv = new SystemCapabilities(tlv_data);
+                        tlv = tlvs.create<SystemCapabilities>(tlv_data);
                         break;
                     case managementAddress:
-                        tlv = new ManagementAddress(tlv_data);
+                        tlv = tlvs.create<ManagementAddress>(tlv_data);
+                        break;
+                    case organizationallySpecific:
+                        tlv = tlvs.create<OrganizationallySpecific>(tlv_data);
                         break;
                 }
             }
 
             if (tlv) {                    // if new TLV object is created, push it into array
+                tlv->tlv_type = type;
                 tlvs.push_back(tlv);
             }
 
@@ -512,7 +817,10 @@ TLVs LLDPPacket::readPacket() const {
         }
     }
 
-    return tlvs;
+    // end of LLDPDU has not been reached
+    if (malformed && counters) {
+        counters->malformed++;
+    }
 }
 
 /**
@@ -523,8 +831,8 @@ TLVs LLDPPacket::readPacket() const {
 void LLDPPacket::appendTLV(TLV &tlv, LLDPPacket &packet) {
     int isSubtype = tlv.getSubType() != -1;
     int subType = tlv.getSubType();
-    u_int16_t tl = htons((((tlv.tlv_type) << 9) |                    // offseting type to first octet - trimmed to only 7 bit
-                 ((tlv.getValue().length + isSubtype) & 0x01FF))); // bitwise OR of 9 bit length - also trimmed by mask
+    u_int16_t tl = htons((((tlv.tlv_type) << TYPE_SHIFT) |                 // offseting type to first octet - trimmed to only 7 bit
+                 ((tlv.getValue().length + isSubtype) & LENGTH_MASK))); // bitwise OR of 9 bit length - also trimmed by mask
 
     // appending type-length items to packet
     packet.appendData(Data((u_int8_t *)&tl, sizeof(u_int16_t)));
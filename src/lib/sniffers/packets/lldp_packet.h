@@ -19,7 +19,6 @@
 #define LLDP_PACKET_H
 
 #include <string>
-#include <map>
 #include <vector>
 #include "packet.h"
 #include "tlv.h"
@@ -35,6 +34,8 @@ public:
 
     static const int ETHER_TYPE = 0x88CC;       /**< Ethernet type for LLDP packet */
     static const int TL_SIZE = 2;               /**< Size of type-value items */
+    static const int TYPE_SHIFT = 9;            /**< Type is in upper 7 bits of type-length items */
+    static const int LENGTH_MASK = 0x01FF;      /**< Length is in lower 9 bits of type-length items */
     static const int MAX_VALUE_SIZE = 256;      /**< Max size of value item */
 
     /**
@@ -49,7 +50,8 @@ public:
         systemName             = 5,
         systemDescription      = 6,
         systemCapabilities     = 7,
-        managementAddress      = 8
+        managementAddress      = 8,
+        organizationallySpecific = 127
     };
 
     /**
@@ -100,7 +102,7 @@ public:
 
         const static int tlv_type  = LLDPPacket::managementAddress;
         const static string tlv_type_str;
-        const static map<int, string> subtypes_str;
+        const static char *const subtypes_str[locallyAssigned + 1];  /**< Names of subtypes */
     };
 
     /**
@@ -143,7 +145,7 @@ public:
 
         const static int tlv_type  = LLDPPacket::portID;
         const static string tlv_type_str;
-        const static map<int, string> subtypes_str;
+        const static char *const subtypes_str[locallyAssigned + 1];  /**< Names of subtypes */
     };
 
     /**
@@ -250,7 +252,7 @@ public:
 
         const static int tlv_type = LLDPPacket::systemCapabilities;
         const static string tlv_type_str;
-        const static map<int, string> capabilities_str;
+        const static char *const capabilities_str[16];  /**< Names of capabilities bits */
     };
 
     /**
@@ -312,10 +314,135 @@ public:
           */
         string getSubTypeName();
 
+        /**
+          * Converts address of family to string.
+          * @param family Address family (subtype), IPv4, IPv6 and all802 are supported.
+          * @param address Address in network order.
+          * @param length Length of address.
+          * @return String representation of address, empty whether family
+          *         is not supported or length does not match.
+          */
+        static string addressToStr(int family, const u_int8_t *address, int length);
+
         const static int tlv_type = LLDPPacket::managementAddress;
         const static string tlv_type_str;
-        const static map<int, string> subtypes_str;
-        const static map<int, string> interfaceNumeringSubtype_str;
+        const static char *const subtypes_str[DNS + 1];      /**< Names of subtypes */
+        const static char *const interfaceNumeringSubtype_str[systemPortNumer + 1];  /**< Names of interface numbering subtypes */
+    };
+
+    /**
+      * Class of organizationally specific value (IEEE 802.1, IEEE 802.3, LLDP-MED).
+      * Value is identified by OUI and subtype, its format is looked up
+      * in table of definitions and fields are read only on demand.
+      * @see TLV
+      */
+    class OrganizationallySpecific :public TLV {
+    public:
+        static const int HEADER_SIZE = 4;   /**< Size of OUI and subtype */
+
+        /**
+          * Organizationally unique identifiers of supported organizations.
+          */
+        enum organizations {
+            IEEE_802_1         = 0x0080C2,
+            IEEE_802_3         = 0x00120F,
+            TIA_MED            = 0x0012BB
+        };
+
+        /**
+          * Formats of values.
+          */
+        enum formats {
+            VLAN_ID,            /**< VLAN ID */
+            PROTOCOL_VLAN_ID,   /**< flags, VLAN ID */
+            VLAN_NAME,          /**< VLAN ID, length, name */
+            PROTOCOL_IDENTITY,  /**< length, protocol identity */
+            LINK_AGGREGATION,   /**< status, aggregated port ID */
+            MAC_PHY_STATUS,     /**< autonegotiation, advertised capabilities, MAU type */
+            POWER_VIA_MDI,      /**< MDI power support, power pair, power class */
+            MAX_FRAME_SIZE,     /**< maximal frame size */
+            MED_CAPABILITIES,   /**< capabilities, device type */
+            NETWORK_POLICY,     /**< application type, flags + VLAN ID + priority + DSCP */
+            LOCATION,           /**< format, location data */
+            EXTENDED_POWER,     /**< power type + source + priority, power value */
+            STRING              /**< string (inventory) */
+        };
+
+        /**
+          * Definition of value of one OUI and subtype.
+          */
+        struct Definition {
+            int format;                 /**< Format from enumeration formats, -1 for undefined */
+            int minLength;              /**< Minimal length of value (without OUI and subtype) */
+            const char *name;           /**< Name of subtype */
+        };
+
+        /**
+          * Decoded fields of value, which fields are set depends on format.
+          */
+        struct Fields {
+            u_int8_t flags;             /**< Status/support flags (protocol VLAN, aggregation, MAC/PHY, power, policy) */
+            u_int8_t kind;              /**< Application type, device type, power class or power type */
+            u_int16_t vlan;             /**< VLAN ID */
+            u_int16_t number;           /**< Frame size, MAU type, MED capabilities, power [0.1 W] */
+            u_int16_t advertised;       /**< Advertised autonegotiation capabilities */
+            u_int32_t port;             /**< Aggregated port ID */
+            u_int8_t priority;          /**< Layer 2 priority or power priority */
+            u_int8_t dscp;              /**< DSCP value */
+            Data text;                  /**< VLAN name, protocol identity, location or string */
+        };
+
+        /**
+          * Constructor which parses OUI, subtype and value.
+          */
+        OrganizationallySpecific(const Data &data);
+        virtual string getTypeName() { return tlv_type_str; }
+
+        /**
+          * Returns name of OUI and subtype.
+          * @return Subtype name of value.
+          */
+        virtual string getSubTypeName();
+
+        /**
+          * Returns converted value in string representation.
+          * @return Value of specified OUI and subtype as a string
+          */
+        virtual const string getValueStr();
+
+        /**
+          * Returns OUI of value.
+          * @return OUI, -1 whether TLV is too short.
+          */
+        int getOUI() const { return oui; }
+
+        /**
+          * Returns definition of value.
+          * @return Definition or NULL whether OUI and subtype is not supported.
+          */
+        const Definition *getDefinition() const { return definition; }
+
+        /**
+          * Reads fields of value by its definition.
+          * @param fields Fields where are values stored.
+          * @return True on success, false whether value is unsupported or malformed.
+          */
+        int readFields(Fields &fields) const;
+
+        /**
+          * Returns definition of OUI and subtype.
+          * @param oui OUI of organization.
+          * @param subtype Subtype of value.
+          * @return Definition or NULL whether is not supported.
+          */
+        static const Definition *findDefinition(int oui, int subtype);
+
+        const static int tlv_type = LLDPPacket::organizationallySpecific;
+        const static string tlv_type_str;
+
+    private:
+        int oui;                        /**< OUI of organization */
+        const Definition *definition;   /**< Definition of value, NULL for unsupported */
     };
 
     /**
@@ -336,11 +463,22 @@ public:
     static int isThisProtocol(Packet *packet, bool onSuccessAddProtocol = true);
 
     /**
-      * Returns array of TLV objects generated from corresponding data of LLDP packet.
-      * @return Array of TLV objects.
+      * Reads array of TLV objects generated from corresponding data of LLDP packet.
+      * TLVs are allocated in arena of packet whether is set (valid until its reset).
+      * Whether projection of packet is set, only TLVs of selected types are read.
+      * @param tlvs Array where are TLV objects stored, its previous content is deleted.
       * @see TLV
       */
-    TLVs readPacket() const;
+    void readPacket(TLVs &tlvs) const;
+
+    /**
+      * Returns TLVs of packet. Whether decode cache of packet is set, TLVs
+      * decoded from identical PDU before are returned (counters are updated
+      * the same), otherwise packet is read by readPacket().
+      * @param tlvs Array where are TLV objects read whether packet has to be decoded.
+      * @return Decoded TLVs, valid until the next packet of sniffer.
+      */
+    const TLVs &decode(TLVs &tlvs) const;
 
     /**
       * Returns size of LLDP packet.
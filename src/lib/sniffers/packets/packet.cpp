@@ -21,7 +21,7 @@
 /** Returns data of which is this packet made out.
   * @return Data of this packet.
   */
-const Data Packet::getData() {
+const Data Packet::getData() const {
     return data;
 }
 
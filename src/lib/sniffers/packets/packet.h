@@ -20,10 +20,16 @@
 
 #include <pcap.h>
 #include <vector>
+#include <cstring>
+#include <ctime>
 #include "frames/data.h"
 
 using namespace std;
 
+class TLVArena;
+class TLVs;
+class DecodeCache;
+
 /**
   * Class of the packet.
   * @todo Not fully implemented. Better work with data.
@@ -32,12 +38,78 @@ class Packet {
 public:
     typedef vector<int> Protocols;  /**< type definition of array of protocols */
 
+    /**
+      * Counters of decoding which are updated by packets of one protocol.
+      */
+    struct Counters {
+        static const int MAX_TLV_TYPES = 128;   /**< Types above are counted together */
+
+        Counters() { memset(this, 0, sizeof(*this)); }
+
+        /**
+          * Counts decoded TLV of type.
+          * @param type Type of TLV.
+          */
+        void countTLV(int type) { tlvs[(type >= 0 && type < MAX_TLV_TYPES) ? type : MAX_TLV_TYPES]++; }
+
+        u_int64_t packets;                      /**< Classified packets */
+        u_int64_t bytes;                        /**< Bytes of classified packets */
+        u_int64_t malformed;                    /**< Malformed or truncated packets */
+        u_int64_t checksumFailures;             /**< Packets with bad checksum */
+        u_int64_t tlvs[MAX_TLV_TYPES + 1];      /**< Decoded TLVs per type, the last one for others */
+    };
+
+    /**
+      * Set of TLV types which are decoded by readPacket(). TLVs of other
+      * types are skipped just by their length, no object is created.
+      */
+    struct Projection {
+        static const int MAX_TLV_TYPES = Counters::MAX_TLV_TYPES;  /**< Types above share one bit */
+
+        Projection() { selectAll(); }
+
+        /**
+          * Selects all types, every TLV is decoded.
+          */
+        void selectAll() { memset(mask, 0xFF, sizeof(mask)); }
+
+        /**
+          * Deselects all types, no TLV is decoded.
+          */
+        void selectNone() { memset(mask, 0, sizeof(mask)); }
+
+        /**
+          * Adds type into set of decoded types.
+          * @param type Type of TLV.
+          */
+        void select(int type) { int bit = bitOf(type); mask[bit / 32] |= u_int32_t(1) << (bit % 32); }
+
+        /**
+          * Tests whether type is decoded.
+          * @param type Type of TLV.
+          * @return True whether TLVs of type are decoded.
+          */
+        int isSelected(int type) const { int bit = bitOf(type); return (mask[bit / 32] >> (bit % 32)) & 1; }
+
+        /**
+          * Returns bit of type in mask.
+          * @param type Type of TLV.
+          * @return Bit of type.
+          */
+        static int bitOf(int type) { return (type >= 0 && type < MAX_TLV_TYPES) ? type : MAX_TLV_TYPES; }
+
+        u_int32_t mask[MAX_TLV_TYPES / 32 + 1]; /**< Bit mask of decoded types, the last bit for others */
+    };
+
     /**
       * Constructor of packet from data and protocols from which is made out.
       * @param data Source data of this packet.
       * @param protocols Protocols from which is made out this packet.
       */
-    Packet(const Data data, Protocols protocols = Protocols()) : protocols(protocols), data(data) { }
+    Packet(const Data data, Protocols protocols = Protocols()) : protocols(protocols), counters(NULL),
+        wireLength(data.length), arena(NULL), projection(NULL), decodeCache(NULL), data(data) {
+        timestamp.tv_sec = timestamp.tv_nsec = 0;
+    }
 
     /**
       * Virtual destrutor which enables calling derived desctructors.
@@ -48,7 +120,7 @@ public:
     /** Returns data of which is this packet made out.
       * @return Data of this packet.
       */
-    const Data getData();
+    const Data getData() const;
 
     /** Appends data to packet.
       * @return newData Data to be appended.
@@ -60,7 +132,22 @@ public:
       */
     virtual int getSize() { return -1; }
 
+    /**
+      * Copies capture informations (timestamp, wire length) from other packet.
+      * @param packet Packet from which is this packet made out.
+      */
+    void copyCaptureInfo(const Packet &packet) {
+        wireLength = packet.wireLength;
+        timestamp = packet.timestamp;
+    }
+
     Protocols protocols;    /**< Array of protocols */
+    Counters *counters;     /**< Decoding counters to be updated, NULL when not counted */
+    int wireLength;         /**< Original length on wire, bigger than data length when truncated by snaplen */
+    struct timespec timestamp;  /**< Capture timestamp (UTC), zero when packet was not captured */
+    TLVArena *arena;        /**< Arena where are decoded TLVs allocated, NULL for heap */
+    const Projection *projection;   /**< Types of TLVs to be decoded, NULL for all */
+    DecodeCache *decodeCache;   /**< Cache of recently decoded PDUs used by decode(), NULL for none */
 
 protected:
     Data data;              /**< Data of packet */
@@ -15,8 +15,9 @@
  * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
  */
 
-#include <map>
 #include <string>
+#include <cstring>
+#include <algorithm>
 #include "frames/data.h"
 #include "tlv.h"
 
@@ -27,11 +28,6 @@ using namespace std;
   */
 const string TLV::tlv_type_str = "(unknown)";
 
-/**
-  * Just definition of reference.
-  */
-const map<int, string> TLV::subtypes_str = map<int, string>();
-
 /**
   * Constructor
   * @param data Data which will be used as a value.
@@ -62,6 +58,14 @@ const string TLV::getValueStr() {
     }
 }
 
+/**
+  * Returns value of malformed TLV (shorter than its format requires).
+  * @return Value as a string in format "malformed (hex) - <value>"
+  */
+const string TLV::getMalformedStr() {
+    return "malformed (hex) - " + Data::arrToHexStr(tlv_value.data, tlv_value.length);
+}
+
 /**
   * Returns type name.
   * @return Type name.
@@ -97,14 +101,73 @@ void TLV::setValue(Data value, int subtype) {
 }
 
 /**
-  * Destructor
+  * Destructor, deletes TLVs (only destructs them whether are in arena)
   */
 TLVs::~TLVs() {
-    TLVs::iterator pos;
+    clear();
+
+    if (items != inlineItems) {
+        delete[] items;
+    }
+}
+
+/**
+  * Appends TLV, array takes ownership of it.
+  * @param tlv TLV created by create().
+  */
+void TLVs::push_back(TLV *tlv) {
+    TLV **grown;
+
+    if (count == capacity) {        // storage is full, doubling
+        grown = new TLV *[capacity * 2];
+        memcpy(grown, items, count * sizeof(TLV *));
+        if (items != inlineItems) {
+            delete[] items;
+        }
+        items = grown;
+        capacity *= 2;
+    }
+
+    items[count++] = tlv;
+}
 
-    // all allocated TLV has to be deallocated before vector destruction
-    for (pos = this->begin(); pos != this->end(); ++pos) {
-        delete *pos;
+/**
+  * Deletes all TLVs.
+  */
+void TLVs::clear() {
+    iterator pos;
+
+    // memory of arena is released by arena itself
+    for (pos = begin(); pos != end(); ++pos) {
+        if (arena) {
+            (*pos)->~TLV();
+        } else {
+            delete *pos;
+        }
     }
+
+    count = 0;
+}
+
+/**
+  * Exchanges content (and ownership) with other array.
+  * @param other Other array.
+  */
+void TLVs::swap(TLVs &other) {
+    TLV *buffer[INLINE_CAPACITY];
+    const bool isInline = items == inlineItems, otherInline = other.items == other.inlineItems;
+
+    memcpy(buffer, inlineItems, sizeof(buffer));
+    memcpy(inlineItems, other.inlineItems, sizeof(buffer));
+    memcpy(other.inlineItems, buffer, sizeof(buffer));
+
+    std::swap(items, other.items);
+    std::swap(count, other.count);
+    std::swap(capacity, other.capacity);
+    std::swap(arena, other.arena);
+
+    // inline storage has been swapped by copying
+    if (otherInline) items = inlineItems;
+    if (isInline) other.items = other.inlineItems;
 }
 
@@ -19,10 +19,10 @@
 #define TLV_H
 
 #include <string>
-#include <map>
 #include <vector>
 
 #include "frames/data.h"
+#include "tlv_arena.h"
 
 using namespace std;
 
@@ -90,9 +90,25 @@ public:
       */
     void setValue(Data value, int subtype = -1);
 
+    /**
+      * Returns value of malformed TLV (shorter than its format requires).
+      * @return Value as a string in format "malformed (hex) - <value>"
+      */
+    const string getMalformedStr();
+
+    /**
+      * Returns name from table of names indexed directly by value.
+      * @param names Table of names, NULL for undefined values.
+      * @param value Value (index into table).
+      * @return Name or NULL whether value is out of table or undefined.
+      */
+    template<size_t N>
+    static const char *tableName(const char *const (&names)[N], int value) {
+        return (value >= 0 && size_t(value) < N) ? names[value] : NULL;
+    }
+
     int tlv_type;                               /**< Type of value */
     const static string tlv_type_str;           /**< Type name */
-    const static map<int, string> subtypes_str; /**< Array of subtype names */
     const static int NO_SUBTYPE = -1;           /**< Just constant */
 protected:
     int tlv_subType;                            /**< Subtype of value */
@@ -100,14 +116,74 @@ protected:
 };
 
 /**
-  * Class of TLV array.
+  * Class of TLV array which owns its TLVs. Array is non-copyable, ownership
+  * can be passed only by swap(). Usual count of TLVs in one packet is
+  * stored inline without any allocation.
   */
-class TLVs: public vector<TLV *> {
+class TLVs {
 public:
+    typedef TLV **iterator;                 /**< Iterator over TLVs */
+    typedef TLV *const *const_iterator;     /**< Constant iterator over TLVs */
+
+    static const size_t INLINE_CAPACITY = 16;   /**< Count of TLVs stored without allocation */
+
+    /**
+      * Constructor
+      * @param arena Arena where are TLVs allocated, NULL for heap.
+      */
+    TLVs(TLVArena *arena = NULL):arena(arena), items(inlineItems), count(0), capacity(INLINE_CAPACITY) {}
+
     /**
-      * Destructor
+      * Destructor, deletes TLVs (only destructs them whether are in arena)
       */
     ~TLVs();
+
+    /**
+      * Creates TLV object in arena of array (or on heap).
+      * @param TLVType Class of TLV.
+      * @param data Data of TLV value.
+      * @return Created TLV.
+      */
+    template<class TLVType>
+    TLV *create(const Data &data) {
+        return (arena) ? new (*arena) TLVType(data) : new TLVType(data);
+    }
+
+    /**
+      * Appends TLV, array takes ownership of it.
+      * @param tlv TLV created by create().
+      */
+    void push_back(TLV *tlv);
+
+    /**
+      * Deletes all TLVs.
+      */
+    void clear();
+
+    /**
+      * Exchanges content (and ownership) with other array.
+      * @param other Other array.
+      */
+    void swap(TLVs &other);
+
+    iterator begin() { return items; }                      /**< @return The first TLV */
+    iterator end() { return items + count; }                /**< @return Behind the last TLV */
+    const_iterator begin() const { return items; }          /**< @return The first TLV */
+    const_iterator end() const { return items + count; }    /**< @return Behind the last TLV */
+    size_t size() const { return count; }                   /**< @return Count of TLVs */
+    bool empty() const { return !count; }                   /**< @return True whether there is no TLV */
+    TLV *operator[](size_t index) const { return items[index]; } /**< @return TLV on index */
+
+    TLVArena *arena;            /**< Arena where are TLVs allocated, NULL for heap */
+
+private:
+    TLVs(const TLVs &);                 /**< Non-copyable */
+    TLVs &operator=(const TLVs &);      /**< Non-copyable */
+
+    TLV *inlineItems[INLINE_CAPACITY];  /**< Inline storage of TLVs */
+    TLV **items;                        /**< Storage of TLVs, inline or allocated */
+    size_t count;                       /**< Count of TLVs */
+    size_t capacity;                    /**< Capacity of storage */
 };
 
 #endif // TLV_H
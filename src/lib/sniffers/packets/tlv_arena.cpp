@@ -0,0 +1,77 @@
+/*******************************************************************************
+ * Projekt:         Programování síťové služby: Sniffer CDP a LLDP
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Modul definující arénu pro alokaci TLV objektů.
+ *
+ ******************************************************************************/
+
+/**
+ * @file tlv_arena.cpp
+ *
+ * @brief Module which defines arena for allocation of TLV objects.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <new>
+#include "tlv_arena.h"
+
+/**
+  * Destructor, frees all blocks.
+  */
+TLVArena::~TLVArena() {
+    reset();
+
+    for (size_t i = 0; i < blocks.size(); i++) {
+        ::operator delete(blocks[i]);
+    }
+}
+
+/**
+  * Allocates memory from arena.
+  * @param size Size of memory [B].
+  * @return Allocated memory, valid until reset().
+  */
+void *TLVArena::allocate(size_t size) {
+    char *memory;
+
+    size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+
+    if (size > BLOCK_SIZE) {        // does not fit into any block
+        large.push_back(static_cast<char *>(::operator new(size)));
+        return large.back();
+    }
+
+    if (block < blocks.size() && used + size <= BLOCK_SIZE) {   // fits into current block
+        memory = blocks[block] + used;
+        used += size;
+        return memory;
+    }
+
+    if (block < blocks.size()) {    // current block is full, next one
+        block++;
+    }
+
+    if (block == blocks.size()) {   // all blocks used, new one
+        blocks.push_back(static_cast<char *>(::operator new(BLOCK_SIZE)));
+    }
+
+    used = size;
+    return blocks[block];
+}
+
+/**
+  * Releases all allocated memory. Destructors of objects
+  * have to be already called.
+  */
+void TLVArena::reset() {
+    for (size_t i = 0; i < large.size(); i++) {
+        ::operator delete(large[i]);
+    }
+
+    large.clear();
+    block = 0;
+    used = 0;
+}
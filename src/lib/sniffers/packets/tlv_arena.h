@@ -0,0 +1,79 @@
+/*******************************************************************************
+ * Projekt:         Programování síťové služby: Sniffer CDP a LLDP
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Hlavičkový soubor deklarující arénu pro alokaci TLV objektů.
+ *
+ ******************************************************************************/
+
+/**
+ * @file tlv_arena.h
+ *
+ * @brief Header file which declares arena for allocation of TLV objects.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef TLV_ARENA_H
+#define TLV_ARENA_H
+
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+/**
+  * Bump allocator of decoded TLV objects. Objects are only constructed
+  * in arena, memory of all of them is released at once by reset().
+  * Allocated blocks are kept for next use, so decoding of packets
+  * does not call malloc/free once arena has grown enough.
+  */
+class TLVArena {
+public:
+    static const size_t BLOCK_SIZE = 4096;  /**< Size of one block of memory [B] */
+    static const size_t ALIGNMENT = 16;     /**< Alignment of allocated objects [B] */
+
+    TLVArena():block(0), used(0) {}
+    ~TLVArena();
+
+    /**
+      * Allocates memory from arena.
+      * @param size Size of memory [B].
+      * @return Allocated memory, valid until reset().
+      */
+    void *allocate(size_t size);
+
+    /**
+      * Releases all allocated memory. Destructors of objects
+      * have to be already called.
+      */
+    void reset();
+
+private:
+    TLVArena(const TLVArena &);                 /**< Non-copyable */
+    TLVArena &operator=(const TLVArena &);      /**< Non-copyable */
+
+    vector<char *> blocks;          /**< Blocks of BLOCK_SIZE */
+    vector<char *> large;           /**< Allocations bigger than BLOCK_SIZE */
+    size_t block;                   /**< Index of currently used block */
+    size_t used;                    /**< Used bytes of current block */
+};
+
+/**
+  * Placement new constructing object in arena.
+  * @param size Size of object.
+  * @param arena Arena where is object allocated.
+  * @return Allocated memory.
+  */
+inline void *operator new(size_t size, TLVArena &arena) {
+    return arena.allocate(size);
+}
+
+/**
+  * Called only when constructor of object allocated in arena throws,
+  * memory is released by reset().
+  */
+inline void operator delete(void *, TLVArena &) {}
+
+#endif // TLV_ARENA_H
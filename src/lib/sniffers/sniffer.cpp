@@ -16,6 +16,9 @@
  */
 
 #include <iostream>
+#include <cerrno>
+#include <cstdio>
+#include <poll.h>
 #include <pcap.h>
 #include "sniffer.h"
 
@@ -44,35 +47,79 @@ void Sniffer::newPacket(Packet *packet) {
 int Sniffer::listening() {
     struct pcap_pkthdr *pkt_header;
     const u_int8_t *pkt_data;
-    int res;
+    struct pollfd pollFds[2];
+    int res, timeout, count, batch;
     Data data;
     Packet *packet;
 
-    while (true) { // Capturing packets and calling newPacket function
-        res = pcap_next_ex(sessionHandle, &pkt_header, &pkt_data);
+    listeningStopped = 0;
+    while (!listeningStopped) { // Waiting for packets or scheduled work
+        if (!sessionHandle) {   // session was lost during reopening
+            return EOPEN_DEVICE;
+        }
 
-        if (res == -1) {    // Unspecified error on listening
-            pcap_geterr(sessionHandle);
+        // session is nonblocking, sleeping until frames or events arrive or work is due
+        count = 0;
+        timeout = nextTick();
+        if (eventFd != -1) {
+            pollFds[count].fd = eventFd;
+            pollFds[count].events = POLLIN;
+            pollFds[count++].revents = 0;
+        }
+        if ((pollFds[count].fd = pcap_get_selectable_fd(sessionHandle)) != -1) {
+            pollFds[count].events = POLLIN;
+            pollFds[count++].revents = 0;
+        } else if (timeout < 0 || timeout > config.timeout) {
+            timeout = config.timeout;   // no selectable descriptor, reading after read timeout
+        }
+
+        if (poll(pollFds, count, timeout) == -1 && errno != EINTR) {
+            perror("Unable wait for packets");
             return EGET_PACKET;
         }
 
-        if (res == -2) {    // Just timeout, maybe next time
-            break;
+        if (eventFd != -1 && (pollFds[0].revents & POLLIN)) {
+            handleEvents();
+            if (listeningStopped || !sessionHandle) {
+                continue;
+            }
         }
 
-        if (res == 1) {     // Got new packet
+        // Processing ready packets and calling newPacket function, events are
+        // checked again after every batch so that stopping is not delayed by flood
+        batch = 0;
+        while (batch++ < BATCH_SIZE && (res = pcap_next_ex(sessionHandle, &pkt_header, &pkt_data)) == 1) {
             // Storing u_int8_t data to Packet object
             data.data = pkt_data;
-            data.length = pkt_header->len;
+            data.length = pkt_header->caplen;   // only captured part is available
             packet = new Packet(data);
+            packet->wireLength = pkt_header->len;
             packet->protocols.push_back(pcap_datalink(sessionHandle));
+            // with nanosecond precision tv_usec holds nanoseconds
+            packet->timestamp.tv_sec = pkt_header->ts.tv_sec;
+            packet->timestamp.tv_nsec = (nanoTimestamps) ? pkt_header->ts.tv_usec : pkt_header->ts.tv_usec * 1000;
 
             newPacket(packet);  // calling newPacket and maybe callback
             delete packet;
         }
-    }
 
-    stopListening();            // Just for sure :)
+        batchDone();
+
+        if (batch > BATCH_SIZE) {   // batch full, more packets may be ready
+            res = 0;
+        }
+
+        if (res == -1) {    // Unspecified error on listening
+            pcap_geterr(sessionHandle);
+            return EGET_PACKET;
+        }
+
+        if (res == -2) {    // Loop broken by stopListening
+            break;
+        }
+
+        tick();
+    }
 
     return 0;
 }
@@ -89,42 +136,142 @@ int Sniffer::startListening() {
         return ret;
     }
 
+    if (!(ret = installFilter())) {
+        ret = listening();          // Finally start listening
+    }
+
+    closeSession();                 // Close session whether still opened
+
+    return ret;
+}
+
+/**
+  * Opens sniffer session.
+  * @return True on succes else false.
+  */
+int Sniffer::openSession() {
+    char errbuf[PCAP_ERRBUF_SIZE];
+    int ret;
+
+    sessionHandle = pcap_create(interface.c_str(), errbuf);
+
+    if (sessionHandle == NULL) {    // session not created
+        cerr << errbuf << endl;
+        return EOPEN_DEVICE;
+    }
+
+    pcap_set_snaplen(sessionHandle, config.snaplen);
+    pcap_set_promisc(sessionHandle, config.promisc);
+    pcap_set_timeout(sessionHandle, config.timeout);
+#ifdef PCAP_TSTAMP_PRECISION_NANO
+    // immediate mode came with libpcap 1.5 as nanosecond timestamps did
+    pcap_set_immediate_mode(sessionHandle, config.immediate);
+#endif
+    if (config.bufferSize > 0) {    // otherwise libpcap default
+        pcap_set_buffer_size(sessionHandle, config.bufferSize);
+    }
+    setTimestamping();
+
+    ret = pcap_activate(sessionHandle);
+
+    if (ret < 0) {                  // session not opened
+        cerr << interface << ": " << pcap_statustostr(ret) << " (" << pcap_geterr(sessionHandle) << ")" << endl;
+        pcap_close(sessionHandle);
+        sessionHandle = NULL;
+        return EOPEN_DEVICE;
+    }
+
+    if (ret > 0) {                  // opened with warning
+        cerr << interface << ": " << pcap_statustostr(ret) << endl;
+    }
+
+    // listening waits in poll() for packets
+    if (pcap_setnonblock(sessionHandle, 1, errbuf) == -1) {
+        cerr << interface << ": " << errbuf << endl;
+    }
+
+#ifdef PCAP_TSTAMP_PRECISION_NANO
+    nanoTimestamps = pcap_get_tstamp_precision(sessionHandle) == PCAP_TSTAMP_PRECISION_NANO;
+#else
+    nanoTimestamps = 0;
+#endif
+
+    return 0;
+}
+
+/**
+  * Sets the most precise timestamp type and precision supported
+  * by interface. Has to be called before activation of session.
+  */
+void Sniffer::setTimestamping() {
+#ifdef PCAP_TSTAMP_ADAPTER
+    // preferred timestamp types, the first supported is used; unsynced
+    // adapter clock is not wall time, so it is never picked
+    static const int PREFERRED[] = {PCAP_TSTAMP_ADAPTER, PCAP_TSTAMP_HOST_HIPREC};
+    int *types, count, found = 0;
+
+    if ((count = pcap_list_tstamp_types(sessionHandle, &types)) > 0) {
+        for (unsigned i = 0; !found && i < sizeof(PREFERRED) / sizeof(PREFERRED[0]); i++) {
+            for (int j = 0; !found && j < count; j++) {
+                if (types[j] == PREFERRED[i]) {
+                    found = pcap_set_tstamp_type(sessionHandle, types[j]) == 0;
+                }
+            }
+        }
+        pcap_free_tstamp_types(types);
+    }
+#endif
+
+#ifdef PCAP_TSTAMP_PRECISION_NANO
+    // falls back to microseconds whether not supported
+    pcap_set_tstamp_precision(sessionHandle, PCAP_TSTAMP_PRECISION_NANO);
+#endif
+}
+
+/**
+  * Compiles sniffer filter and installs it above opened session.
+  * @return True on succes else false.
+  */
+int Sniffer::installFilter() {
+    struct bpf_program compiledFilter;
+
     // Compile sniffer filter
     if (pcap_compile(sessionHandle, &compiledFilter, filter.c_str(), 0, 0) == -1) {
         pcap_geterr(sessionHandle);
         return EPARSE_FILTER;
     }
 
-    // Set compiled filter above session
+    // Set compiled filter above session, program is copied by libpcap
     if (pcap_setfilter(sessionHandle, &compiledFilter) == -1) {
         pcap_geterr(sessionHandle);
+        pcap_freecode(&compiledFilter);
         return EINSTALL_FILTER;
     }
 
-    ret = listening();              // Finally start listening
-
-    closeSession();                 // Close session whether still opened
     pcap_freecode(&compiledFilter);
 
-    return ret;
+    return 0;
 }
 
 /**
-  * Opens sniffer session.
+  * Reopens listening session with current settings (e.g. changed
+  * buffer size) and installs filter again.
   * @return True on succes else false.
   */
-int Sniffer::openSession() {
-    char errbuf[PCAP_ERRBUF_SIZE];
+int Sniffer::reopenSession() {
+    int ret;
 
-    //sessionHandle = pcap_open_offline("lldp.detailed.pcap", errbuf);
-    sessionHandle = pcap_open_live(interface.c_str(), BUFSIZ, 1, 1000, errbuf);
+    closeSession();
 
-    if (sessionHandle == NULL) {    // session not opened
-        cerr << errbuf << endl;
-        return EOPEN_DEVICE;
+    if ((ret = openSession())) {
+        return ret;
     }
 
-    return 0;
+    if ((ret = installFilter())) {
+        closeSession();
+    }
+
+    return ret;
 }
 
 /**
@@ -141,6 +288,7 @@ void Sniffer::closeSession() {
   * Stops listening on sniffer interface.
   */
 void Sniffer::stopListening() {
+    listeningStopped = 1;
     if (sessionHandle) {
         pcap_breakloop(sessionHandle);
     }
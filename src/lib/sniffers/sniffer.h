@@ -21,6 +21,10 @@
 #include <string>
 #include <pcap.h>
 #include "packets/packet.h"
+#include "packets/frames/ethernet_frame.h"
+#include "packets/tlv_arena.h"
+#include "latency_histogram.h"
+#include "decode_cache.h"
 
 using namespace std;
 
@@ -48,8 +52,51 @@ public:
 
     static const string DEFAULT_INTERFACE;  /**< Default interface name */
     static const string FILTER;             /**< Current filter for sniffer */
+    static const int DEFAULT_BUFFER_SIZE = 2 * 1024 * 1024;     /**< Kernel buffer size used by libpcap when not set [B] */
+    static const int DEFAULT_SNAPLEN = EthernetFrame::MAX_SIZE;  /**< Maximal size of LLDP/CDP frame [B] */
+    static const int DEFAULT_TIMEOUT = 1000;                    /**< Default read timeout [ms] */
+    static const int LOW_LATENCY_TIMEOUT = 50;                  /**< Read timeout of low latency preset [ms] */
+    static const int BATCH_SIZE = 256;                          /**< Packets processed between checks of events */
 
-    Sniffer():captureCallback(NULL), interface(DEFAULT_INTERFACE), sessionHandle(0) {}
+    /**
+      * Settings of capture session which are applied when session is opened.
+      */
+    struct CaptureConfig {
+        CaptureConfig():snaplen(DEFAULT_SNAPLEN), timeout(DEFAULT_TIMEOUT), immediate(0),
+            promisc(1), bufferSize(0), maxBufferSize(0) {}
+
+        /**
+          * Returns preset which delivers every frame as soon as it arrives
+          * and wakes up often enough for prompt stopping of listening.
+          * @return Low latency capture settings.
+          */
+        static CaptureConfig lowLatency() {
+            CaptureConfig config;
+            config.immediate = 1;
+            config.timeout = LOW_LATENCY_TIMEOUT;
+            return config;
+        }
+
+        /**
+          * Compares settings which can be applied only by reopening of session.
+          * @param other Other settings.
+          * @return True whether session opened with other settings would be the same.
+          */
+        int sameSession(const CaptureConfig &other) const {
+            return snaplen == other.snaplen && timeout == other.timeout && immediate == other.immediate
+                && promisc == other.promisc && bufferSize == other.bufferSize;
+        }
+
+        int snaplen;                    /**< Bytes of each frame copied from kernel */
+        int timeout;                    /**< Read timeout [ms], frames are buffered in kernel up to this time */
+        int immediate;                  /**< Deliver frames immediately, without buffering in kernel */
+        int promisc;                    /**< Promiscuous mode */
+        int bufferSize;                 /**< Kernel capture buffer size [B], 0 for libpcap default */
+        int maxBufferSize;              /**< Ceiling for growing of buffer on drops [B], 0 disables growing */
+    };
+
+    Sniffer():captureCallback(NULL), interface(DEFAULT_INTERFACE), protocol(-1),
+        sessionHandle(0), nanoTimestamps(0), listeningStopped(0), eventFd(-1) {}
     virtual ~Sniffer() {}
 
     /**
@@ -71,6 +118,12 @@ public:
       */
     int startListening();
 
+    /**
+      * Is called after batch of packets has been delivered to callbacks,
+      * releases memory of TLVs decoded in the batch.
+      */
+    virtual void batchDone() { arena.reset(); }
+
     /**
       * Stops listening on sniffer interface.
       */
@@ -84,9 +137,17 @@ public:
     CaptureCallback captureCallback;    /**< Capture callback function */
     string interface;                   /**< Name of interface where sniffer runs */
     string filter;                      /**< Filter which is used for sniffing */
+    int protocol;                       /**< Protocol which is sniffed (-1 when more or none) */
+    LatencyHistogram latency;           /**< Capture to callback completion latency [ns] */
+    Packet::Counters counters;          /**< Counters of packets of sniffed protocol */
+    TLVArena arena;                     /**< Arena of TLVs decoded in current batch */
+    Packet::Projection projection;      /**< Types of TLVs decoded for callback, all by default */
+    DecodeCache decodeCache;            /**< Recently decoded PDUs, identical announcements are not read again */
+    CaptureConfig config;               /**< Settings of capture session */
 
 protected:
-    Sniffer(string filter):filter(filter) {}
+    Sniffer(string filter, int protocol):captureCallback(NULL), interface(DEFAULT_INTERFACE),
+        filter(filter), protocol(protocol), sessionHandle(0), nanoTimestamps(0), listeningStopped(0), eventFd(-1) {}
 
     /**
       * Is called when new packet is captured during listening.
@@ -106,13 +167,52 @@ protected:
       */
     int openSession();
 
+    /**
+      * Sets the most precise timestamp type and precision supported
+      * by interface. Has to be called before activation of session.
+      */
+    void setTimestamping();
+
+    /**
+      * Compiles sniffer filter and installs it above opened session.
+      * @return True on succes else false.
+      */
+    int installFilter();
+
+    /**
+      * Reopens listening session with current settings (e.g. changed
+      * buffer size) and installs filter again.
+      * @return True on succes else false.
+      */
+    int reopenSession();
+
     /**
       * Closes opened session whether exists.
       */
-    void closeSession();
+    virtual void closeSession();
+
+    /**
+      * Is called from listening loop after every batch of captured
+      * packets and whenever time returned by nextTick() expires.
+      */
+    virtual void tick() {}
+
+    /**
+      * Returns time until tick() has some work to do, listening sleeps
+      * at most this time when no packet arrives.
+      * @return Time until next scheduled work [ms], -1 when nothing is scheduled.
+      */
+    virtual int nextTick() { return -1; }
+
+    /**
+      * Is called from listening loop when eventFd becomes readable.
+      */
+    virtual void handleEvents() {}
 
     pcap_t *sessionHandle;              /**< PCAP session handle */
-    struct bpf_program compiledFilter;  /**< Compiled sniffing filter */
+    int nanoTimestamps;                 /**< Timestamps of session are in nanoseconds (else microseconds) */
+    volatile int listeningStopped;      /**< Signalizes that listening has been stopped */
+    int eventFd;                        /**< Descriptor of events polled together with session, -1 for none */
 };
 
 #endif
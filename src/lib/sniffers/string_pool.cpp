@@ -0,0 +1,161 @@
+/*******************************************************************************
+ * Projekt:         Programování síťové služby: Sniffer CDP a LLDP
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Modul definující sdílené úložiště řetězců.
+ *
+ ******************************************************************************/
+
+/**
+ * @file string_pool.cpp
+ *
+ * @brief Module which defines pool of interned strings.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <cstring>
+#include <new>
+#include "string_pool.h"
+
+StringPool::StringPool():buckets(MIN_BUCKETS, (String *)NULL), count(0), stored(0) {
+}
+
+/**
+  * Destructor, frees all strings regardless of references.
+  */
+StringPool::~StringPool() {
+    String *str, *next;
+
+    for (size_t i = 0; i < buckets.size(); i++) {
+        for (str = buckets[i]; str; str = next) {
+            next = str->next;
+            operator delete(str);
+        }
+    }
+}
+
+/**
+  * Returns FNV-1a hash of bytes.
+  * @param data Bytes.
+  * @param length Count of bytes.
+  * @return Hash of bytes.
+  */
+u_int32_t StringPool::hash(const u_int8_t *data, int length) {
+    u_int32_t value = 2166136261u;
+
+    for (int i = 0; i < length; i++) {
+        value = (value ^ data[i]) * 16777619u;
+    }
+
+    return value;
+}
+
+/**
+  * Returns interned string with given bytes without taking reference.
+  * @param data Bytes of string.
+  * @param length Count of bytes.
+  * @return Interned string or NULL whether is not in pool.
+  */
+const StringPool::String *StringPool::find(const u_int8_t *data, int length) const {
+    u_int32_t value = hash(data, length);
+    const String *str;
+
+    for (str = buckets[value & (buckets.size() - 1)]; str; str = str->next) {
+        if (str->hash == value && str->size == length && (!length || !memcmp(str->chars, data, length))) {
+            return str;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+  * Returns interned string with given bytes and takes reference of it.
+  * @param data Bytes of string.
+  * @param length Count of bytes.
+  * @return Interned string, released by release().
+  */
+const StringPool::String *StringPool::intern(const u_int8_t *data, int length) {
+    u_int32_t value = hash(data, length);
+    String **bucket = &buckets[value & (buckets.size() - 1)];
+    String *str;
+
+    for (str = *bucket; str; str = str->next) {
+        if (str->hash == value && str->size == length && (!length || !memcmp(str->chars, data, length))) {
+            str->references++;
+            return str;
+        }
+    }
+
+    // bytes are stored behind the header, chars[1] holds terminator
+    str = static_cast<String *>(operator new(sizeof(String) + length));
+
+    if (length) {
+        memcpy(str->chars, data, length);
+    }
+    str->chars[length] = '\0';
+    str->size = length;
+    str->hash = value;
+    str->references = 1;
+    str->next = *bucket;
+    *bucket = str;
+
+    stored += length;
+    if (++count > buckets.size()) {     // keeping chains short
+        grow();
+    }
+
+    return str;
+}
+
+/**
+  * Takes another reference of interned string.
+  * @param str Interned string, NULL is ignored.
+  * @return The same string.
+  */
+const StringPool::String *StringPool::acquire(const String *str) {
+    if (str) {
+        const_cast<String *>(str)->references++;
+    }
+    return str;
+}
+
+/**
+  * Releases reference of interned string, the last one frees it.
+  * @param str Interned string, NULL is ignored.
+  */
+void StringPool::release(const String *str) {
+    String **link;
+
+    if (!str || --const_cast<String *>(str)->references) {
+        return;
+    }
+
+    // unlinking from its chain
+    for (link = &buckets[str->hash & (buckets.size() - 1)]; *link != str; link = &(*link)->next);
+    *link = str->next;
+
+    stored -= str->size;
+    count--;
+    operator delete(const_cast<String *>(str));
+}
+
+/**
+  * Doubles count of buckets and redistributes strings.
+  */
+void StringPool::grow() {
+    vector<String *> grown(buckets.size() * 2, (String *)NULL);
+    String *str, *next;
+
+    for (size_t i = 0; i < buckets.size(); i++) {
+        for (str = buckets[i]; str; str = next) {
+            next = str->next;
+            str->next = grown[str->hash & (grown.size() - 1)];
+            grown[str->hash & (grown.size() - 1)] = str;
+        }
+    }
+
+    buckets.swap(grown);
+}
@@ -0,0 +1,133 @@
+/*******************************************************************************
+ * Projekt:         Programování síťové služby: Sniffer CDP a LLDP
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Hlavičkový soubor deklarující sdílené úložiště řetězců.
+ *                  Stejné řetězce jsou uloženy pouze jednou.
+ *
+ ******************************************************************************/
+
+/**
+ * @file string_pool.h
+ *
+ * @brief Header file which declares pool of interned strings. Equal strings
+ *        are stored only once and can be compared by pointer.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include <sys/types.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+  * Pool of interned reference counted strings. Every distinct string
+  * (any bytes, not only text) is stored once, so strings of the pool
+  * are equal exactly when their pointers are equal. String is freed
+  * when its last reference is released.
+  */
+class StringPool {
+public:
+    /**
+      * Interned string, immutable while referenced.
+      */
+    class String {
+    public:
+        const char *c_str() const { return chars; }         /**< @return Terminated chars */
+        const u_int8_t *data() const { return (const u_int8_t *)chars; }   /**< @return Bytes */
+        int length() const { return size; }                 /**< @return Length without terminator */
+        string str() const { return string(chars, size); }  /**< @return Copy as string */
+
+    private:
+        friend class StringPool;
+
+        String *next;               /**< Next string in bucket */
+        u_int32_t hash;             /**< Hash of bytes */
+        u_int32_t references;       /**< Count of references */
+        int size;                   /**< Length of string */
+        char chars[1];              /**< Bytes followed by terminator */
+    };
+
+    static const size_t MIN_BUCKETS = 64;   /**< Initial count of buckets, power of two */
+
+    StringPool();
+    ~StringPool();
+
+    /**
+      * Returns interned string with given bytes and takes reference of it.
+      * @param data Bytes of string.
+      * @param length Count of bytes.
+      * @return Interned string, released by release().
+      */
+    const String *intern(const u_int8_t *data, int length);
+
+    /**
+      * Returns interned string equal to string and takes reference of it.
+      * @param str String to be interned.
+      * @return Interned string, released by release().
+      */
+    const String *intern(const string &str) { return intern((const u_int8_t *)str.data(), str.length()); }
+
+    /**
+      * Returns interned string with given bytes without taking reference.
+      * @param data Bytes of string.
+      * @param length Count of bytes.
+      * @return Interned string or NULL whether is not in pool.
+      */
+    const String *find(const u_int8_t *data, int length) const;
+
+    /**
+      * Takes another reference of interned string.
+      * @param str Interned string, NULL is ignored.
+      * @return The same string.
+      */
+    const String *acquire(const String *str);
+
+    /**
+      * Releases reference of interned string, the last one frees it.
+      * @param str Interned string, NULL is ignored.
+      */
+    void release(const String *str);
+
+    /**
+      * Returns count of distinct strings.
+      * @return Count of distinct strings.
+      */
+    size_t size() const { return count; }
+
+    /**
+      * Returns count of bytes held by distinct strings (without overhead).
+      * @return Count of bytes.
+      */
+    size_t bytes() const { return stored; }
+
+private:
+    StringPool(const StringPool &);             /**< Non-copyable */
+    StringPool &operator=(const StringPool &);  /**< Non-copyable */
+
+    /**
+      * Returns FNV-1a hash of bytes.
+      * @param data Bytes.
+      * @param length Count of bytes.
+      * @return Hash of bytes.
+      */
+    static u_int32_t hash(const u_int8_t *data, int length);
+
+    /**
+      * Doubles count of buckets and redistributes strings.
+      */
+    void grow();
+
+    vector<String *> buckets;       /**< Chains of strings, count is power of two */
+    size_t count;                   /**< Count of distinct strings */
+    size_t stored;                  /**< Bytes of distinct strings */
+};
+
+#endif // STRING_POOL_H